@@ -4,7 +4,176 @@
 #include <cstdlib>
 #include <ctime>
 #include <stdlib.h>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstdio>
+#include <csignal>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
+//======================================================================================================================
+/**
+ * @struct GameRules
+ * @brief The numbers a format is played with.
+ *
+ * StandardRules is the format of the interactive game and the default of the engine. A reference to a constexpr
+ * ruleset can be a template argument (see StaticRules), so the interactive game sizes its arrays with it and the
+ * engine deals a standard game with the limits folded in. Variant formats such as 20 hp or 40-card decks pass their
+ * own GameRules to GameState::reset(); the turn itself reads the few limits it needs from GameState::rules at run time
+ * in every format. See GameState::supportsRules() for the limits.
+ */
+struct GameRules
+{
+    int startingHp;
+    int handLimit;       // a player holding this many cards draws nothing and can not take a card back to hand
+    int openingHand;     // cards dealt before the first turn
+    int deckSize;        // library cards a player starts with; the dealt decks must hold exactly this many
+    int attackSquadSize; // creatures a player can send into one attack
+
+    constexpr bool operator==(const GameRules &other) const
+    {
+        return startingHp == other.startingHp && handLimit == other.handLimit && openingHand == other.openingHand && deckSize == other.deckSize &&
+               attackSquadSize == other.attackSquadSize;
+    }
+    constexpr bool operator!=(const GameRules &other) const { return !(*this == other); }
+}; // GameRules struct
+
+inline constexpr GameRules StandardRules = {15, 7, 5, 26, 9};
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct StaticRules
+ * @brief A constexpr ruleset as a type: the members of GameRules as compile-time constants.
+ *
+ * Code templated on the rules type takes either a GameRules (run time) or a StaticRules, with which the compiler folds
+ * the limits and gives the loops over them fixed trip counts.
+ */
+template <const GameRules &Rules>
+struct StaticRules
+{
+    static constexpr int startingHp = Rules.startingHp;
+    static constexpr int handLimit = Rules.handLimit;
+    static constexpr int openingHand = Rules.openingHand;
+    static constexpr int deckSize = Rules.deckSize;
+    static constexpr int attackSquadSize = Rules.attackSquadSize;
+}; // StaticRules struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class StaticVector
+ * @brief A vector whose storage is an inline array of Capacity elements.
+ *
+ * It never allocates and is trivially copyable when T is, so a struct of StaticVectors can still be copied with
+ * memcpy. Indexing and growing past the capacity are checked with assert: debug builds stop on an overflow and release
+ * builds pay nothing. Removed elements are reset to T(), so two vectors holding the same elements are also equal byte
+ * for byte.
+ */
+template <typename T, int Capacity>
+class StaticVector
+{
+public:
+    static_assert(Capacity > 0, "a StaticVector needs room for at least one element");
+
+    static constexpr int capacity() { return Capacity; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == Capacity; }
+
+    T *data() { return items; }
+    const T *data() const { return items; }
+    T *begin() { return items; }
+    T *end() { return items + count; }
+    const T *begin() const { return items; }
+    const T *end() const { return items + count; }
+
+    T &operator[](int index)
+    {
+        assert(index >= 0 && index < count);
+        return items[index];
+    }
+    const T &operator[](int index) const
+    {
+        assert(index >= 0 && index < count);
+        return items[index];
+    }
+
+    T &back()
+    {
+        assert(count > 0);
+        return items[count - 1];
+    }
+
+    void push_back(const T &value)
+    {
+        assert(count < Capacity);
+        items[count++] = value;
+    }
+
+    void pop_back()
+    {
+        assert(count > 0);
+        items[--count] = T();
+    }
+
+    /**
+     * @brief Removes the element at index and closes the gap, keeping the order of the others.
+     */
+    void erase(int index)
+    {
+        assert(index >= 0 && index < count);
+        for (int i = index; i + 1 < count; i++)
+        {
+            items[i] = items[i + 1];
+        }
+        items[--count] = T();
+    }
+
+    /**
+     * @brief Sets the size; new elements are T(), for filling through data().
+     */
+    void resize(int size)
+    {
+        assert(size >= 0 && size <= Capacity);
+        for (int i = size; i < count; i++)
+        {
+            items[i] = T();
+        }
+        count = size;
+    }
+
+    void clear() { resize(0); }
+
+private:
+    T items[Capacity] = {};
+    int count = 0;
+}; // StaticVector class
 //======================================================================================================================
 /**
  * @class Mana
@@ -14,7 +183,8 @@
  * It provides methods to reset the mana each turn, print the mana information, get user input for mana selection,
  * check if the mana is enough to play a card, and deduct mana when playing a card.
  *
- * The class also includes a map that stores the mana costs and requirements for each card in the game.
+ * The mana costs and requirements of each card are read by name from the active card pool (getActiveCardTable()), so
+ * the active pool must be the one the game was dealt from; playLegacyGame() is run with it.
  * It provides methods to check if the player has enough mana for a card and to get the count of a specific type of mana.
  *
  * The Mana class can be inherited to add additional functionality or mana types.
@@ -28,7 +198,7 @@ protected:
     int blueMana;
     int blackMana;
     int colorlessManaSum;
-    std::string cardName;
+    std::string_view cardName;
 
 public:
     Mana() : whiteMana(1), redMana(1), greenMana(1), blueMana(1), blackMana(1), colorlessManaSum(whiteMana + redMana + greenMana + blueMana + blackMana) {}
@@ -128,65 +298,14 @@ public:
      *
      * @param cardName The name of the card.
      */
-    void cost(const std::string &cardName)
-    {
-        const int colorlessManaSum = whiteMana + redMana + greenMana + blueMana + blackMana;
-
-        // Map to store mana costs for each card
-        std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> manaCosts = {
-            {"Soldier", {{"white", 1}}},
-            {"ArmoredPegasus", {{"white", 1}, {"colorless", 1}}},
-            {"WhiteKnight", {{"white", 2}}},
-            {"AngryBear", {{"green", 1}, {"colorless", 2}}},
-            {"Guard", {{"white", 2}, {"colorless", 2}}},
-            // ... (continue for other cards)
-        };
-
-        auto it = manaCosts.find(cardName);
-        if (it != manaCosts.end())
-        {
-            // Check if the player has enough mana for the card
-            for (const auto &cost : it->second)
-            {
-                if (cost.first == "colorless" && cost.second <= colorlessManaSum)
-                {
-                    continue;
-                }
-                else if (cost.second > getManaCount(cost.first))
-                {
-                    std::cout << "Not enough mana for " << cardName << ". " << std::endl;
-                    return;
-                }
-            }
-
-            // Deduct the mana cost
-            for (const auto &cost : it->second)
-            {
-                if (cost.first != "colorless")
-                {
-                    deductMana(cost.first);
-                }
-                else
-                {
-                    for (int i = 0; i < cost.second; ++i)
-                    {
-                        deductMana(cost.first);
-                    }
-                }
-            }
-        }
-        else
-        {
-            std::cout << "Card " << cardName << " not found." << std::endl;
-        }
-    }
+    void cost(std::string_view cardName);
     //----------------------------------------------------------------------------------------------------------------------
     /**
      * Deducts mana of the specified type.
      *
      * @param manaType The type of mana to deduct.
      */
-    void deductMana(const std::string &manaType)
+    void deductMana(std::string_view manaType)
     {
         if (manaType == "white")
         {
@@ -216,69 +335,16 @@ public:
      * @param cardName The name of the card.
      * @return True if the mana is enough, false otherwise.
      */
-    bool isManaEnough(const std::string &cardName)
-    {
-        const int colorlessManaSum = whiteMana + redMana + greenMana + blueMana + blackMana;
-
-        // Map to store mana requirements for each card
-        std::unordered_map<std::string, std::vector<std::pair<std::string, int>>> manaRequirements = {
-            {"Soldier", {{"white", 1}}},
-            {"ArmoredPegasus", {{"white", 1}, {"colorless", 1}}},
-            {"WhiteKnight", {{"white", 2}}},
-            {"AngryBear", {{"green", 1}, {"colorless", 2}}},
-            {"Guard", {{"white", 2}, {"colorless", 2}}},
-            {"Werewolf", {{"white", 1}, {"green", 1}, {"colorless", 2}}},
-            {"Skeleton", {{"black", 1}}},
-            {"Ghost", {{"black", 1}, {"colorless", 1}}},
-            {"BlackKnight", {{"black", 2}}},
-            {"OrcManiac", {{"red", 1}, {"colorless", 2}}},
-            {"Hobgoblin", {{"red", 1}, {"black", 1}, {"colorless", 1}}},
-            {"Vampire", {{"black", 1}, {"colorless", 3}}},
-
-            // Sorcery Cards
-            {"Disenchant", {{"white", 1}, {"colorless", 1}}},
-            {"LightningBolt", {{"green", 1}, {"colorless", 1}}},
-            {"Flood", {{"white", 1}, {"green", 1}, {"colorless", 1}}},
-            {"Reanimate", {{"black", 1}}},
-            {"Plague", {{"black", 1}, {"colorless", 2}}},
-            {"Terror", {{"black", 1}, {"colorless", 1}}},
-
-            // Enchantment Cards
-            {"Rage", {{"green", 1}}},
-            {"HolyWar", {{"white", 1}, {"colorless", 1}}},
-            {"HolyLight", {{"white", 1}, {"colorless", 1}}},
-            {"UnholyWar", {{"black", 1}, {"colorless", 1}}},
-            {"Restrain", {{"red", 1}, {"colorless", 2}}},
-            {"Slow", {{"black", 1}}},
-
-            // Basic Lands
-            {"Plains", {{"colorless", 1}}},
-            {"Island", {{"colorless", 1}}},
-            {"Mountain", {{"colorless", 1}}},
-            {"Swamp", {{"colorless", 1}}},
-            {"Forest", {{"colorless", 1}}}};
-
-        // Check if the card exists in the map
-        auto it = manaRequirements.find(cardName);
-        if (it != manaRequirements.end())
-        {
-            // Check if the player has enough mana for the card
-            for (const auto &requirement : it->second)
-            {
-                if (requirement.first == "colorless" && requirement.second <= colorlessManaSum)
-                {
-                    continue;
-                }
-                else if (requirement.second > getManaCount(requirement.first))
-                {
-                    return false;
-                }
-            }
-            return true;
-        }
-
-        return false; // Card not found in the map
-    }
+    bool isManaEnough(std::string_view cardName);
+    //----------------------------------------------------------------------------------------------------------------------
+    /**
+     * Pays the whole cost of a card without asking: the colored part from its pools and the generic part from the
+     * largest pools first.
+     *
+     * @param cardName The name of the card.
+     * @return True if the card was paid for, false (and nothing is deducted) if the mana is not enough.
+     */
+    bool spend(std::string_view cardName);
     //----------------------------------------------------------------------------------------------------------------------
     /**
      * @brief Get the count of mana of a specific type.
@@ -286,7 +352,7 @@ public:
      * @param manaType The type of mana to count.
      * @return The count of mana of the specified type.
      */
-    int getManaCount(const std::string &manaType)
+    int getManaCount(std::string_view manaType)
     {
         if (manaType == "white")
         {
@@ -319,33 +385,23 @@ public:
      *
      * @param c The card for which the mana needs to be increased.
      */
-    virtual void increaseManaWithTap(std::string c)
-    {
-        cardName = c;
-
-        if (c == "Forest")
-        {
-            greenMana++;
-        }
-        else if (c == "Island")
-        {
-            blueMana++;
-        }
-        else if (c == "Mountain")
-        {
-            redMana++;
-        }
-        else if (c == "Plains")
-        {
-            whiteMana++;
-        }
-        else if (c == "Swamp")
-        {
-            blackMana++;
-        }
-    }
+    virtual void increaseManaWithTap(std::string_view c);
 }; // Mana class
 //======================================================================================================================
+/**
+ * @brief The kind of a card, the closed set of card types the game knows. Both the Card class and the card prototypes
+ * of the headless engine are tagged with it.
+ */
+enum class CardKind : std::uint8_t
+{
+    Land,
+    Creature,
+    Sorcery,
+    Enhancement
+};
+
+struct CardPrototype;
+//======================================================================================================================
 /**
  * @class Card
  * @brief Represents a card in a card game.
@@ -353,307 +409,241 @@ public:
  * The Card class provides functionality to create and manipulate cards in a card game.
  * It contains properties such as card name, type, and color, as well as various methods
  * for printing card information, modifying card stats, and performing card actions.
- * This class serves as a base class for specific types of cards in the game.
+ *
+ * Card is a plain value type tagged with its CardKind. The card types are a closed set, so instead of a virtual method
+ * per type every method checks the tag itself: the stat changes only touch creatures, only lands produce mana when
+ * tapped. There is no vtable, cards are stored by value in the zones and the per-card sweeps (untapped, baseHp) run
+ * over contiguous memory with calls the compiler can inline. LandCard, CreatureCard, SorceryCard and EnhancementCard
+ * only add the constructors of each kind and no state, so they can be stored as a Card.
+ *
+ * The text of a card (name, type, color, mana cost and effect) is not owned by it. The constructors take string
+ * literals and the getters return string_views into them, so comparing or printing a name and moving a card between
+ * zones never allocate.
+ *
+ * fromPrototype() builds the card a CardPrototype of a card database describes; its name points into the pool, which
+ * has to outlive the game.
  */
 class Card
 {
 
 protected:
-    std::string cardName, cardType, cardColor;
+    std::string_view cardName, cardType, cardColor;
+    std::string_view manaCost, effect;
+    CardKind kind = CardKind::Land;
+    int attackPower = 0;
+    int baseHP = 0;
+    int hp = 0;
+    bool baseFirstStrike = false;
+    bool baseTrample = false;
+    bool firstStrike = false;
+    bool trample = false;
+    bool hasTapped = false;
+
+    Card(CardKind k, const char *cN, const char *tP, const char *c) : cardName(cN), cardType(tP), cardColor(c), kind(k) {}
 
 public:
     Card() {}
-    Card(std::string cN, std::string tP, std::string c) : cardName(cN), cardType(tP), cardColor(c) {}
 
-    virtual void printCardName() { std::cout << cardName; }
+    /**
+     * @brief Builds a card from its printed definition, with the type and color texts of the matching card class.
+     */
+    static Card fromPrototype(const CardPrototype &proto);
+
+    void printCardName() { std::cout << cardName; }
     void printCardtype() { std::cout << cardType; }
     void printCardColor() { std::cout << cardColor; }
 
-    std::string getCardName() { return cardName; }
-    std::string getCardtype() { return cardType; }
-    std::string getCardColor() { return cardColor; }
-
-    virtual void BoostStats(){};
-    virtual void DecreaseStats(){};
-    virtual void BoostAttack(){};
-    virtual void deal1Dmg(){};
-    virtual void deal2Dmg(){};
-    virtual void setUntapped(){};
-    virtual void setTapped(std::unique_ptr<Mana> &mana){};
-    virtual void setFirstStrike(){};
-    virtual void setTrample(){};
-    virtual void removeTrample(){};
-    virtual void removeFirstStrike(){};
-    virtual bool getFirstStrike() { return false; };
-    virtual bool getTrample() { return false; };
-    virtual void play(std::unique_ptr<Mana> &mana)
-    {
-        std::cout << "Card play function ";
-        mana->cost(cardName);
-    }
-    virtual bool isManaE(std::unique_ptr<Mana> &mana) { return mana->isManaEnough(cardName); }
-    virtual void goBaseHp(){};
-    virtual bool hasTappedInfo() { return false; }
-
-    virtual int getHp() { return 0; }
-    virtual int getAttackPower() { return 0; }
-    virtual void sustainDamage(int dmg) {}
-    virtual bool checkDead() { return false; }
-
-    virtual void trampleBase() {}
-    virtual void firstStrikeBase() {}
-
-    virtual void reverseHolyWar() {}
-    virtual void reverseHolylight() {}
-    virtual void reverseUnholyWar() {}
-}; // Card class
-//======================================================================================================================
-/**
- * @brief The LandCard class represents a land card in a card game.
- *
- * It inherits from the Card class and adds functionality specific to land cards.
- */
-class LandCard : public Card
-{
-protected:
-    bool hasTapped;
-
-public:
-    /**
-     * @brief Default constructor for LandCard.
-     */
-    LandCard() : Card(), hasTapped(0) {}
+    std::string_view getCardName() const { return cardName; }
+    std::string_view getCardtype() const { return cardType; }
+    std::string_view getCardColor() const { return cardColor; }
+    CardKind getKind() const { return kind; }
+    bool isCreature() const { return kind == CardKind::Creature; }
 
     /**
-     * @brief Constructor for LandCard with specified parameters.
-     *
-     * @param cN The name of the card.
-     * @param t The type of the card.
-     * @param hT A boolean indicating whether the card has been tapped.
+     * @brief Adds attack and hp to a creature, as the stat changing enhancements do; negative amounts take them away.
      */
-    LandCard(std::string cN, std::string t, bool hT) : Card(cN, t, " "), hasTapped(hT) {}
+    void changeStats(int attack, int hpChange)
+    {
+        if (isCreature())
+        {
+            attackPower += attack;
+            hp += hpChange;
+        }
+    }
 
     /**
-     * @brief Plays the land card.
-     *
-     * @param mana A reference to a unique_ptr of Mana.
+     * @brief Takes back an attack bonus, but never below 0 attack, as when UnholyWar is destroyed.
      */
-    void play(std::unique_ptr<Mana> &mana)
+    void reverseAttackBoost(int attack)
     {
-        std::cout << "land card play function ";
-        mana->cost(cardName);
+        if (isCreature() && attackPower > 0)
+        {
+            attackPower = attackPower > attack ? attackPower - attack : 0;
+        }
     }
 
-    /**
-     * @brief Prints the name of the card.
-     */
-    void printCardName() { std::cout << cardName; }
+    int dealAttack() { return attackPower; }
 
     /**
-     * @brief Sets the land card as untapped.
+     * @brief Untaps the card. Only lands and creatures ever become tapped.
      */
     void setUntapped() { hasTapped = false; }
 
     /**
-     * @brief Sets the land card as tapped and increases mana with tap.
+     * @brief Taps a land for mana. Tapping any other kind of card this way does nothing.
      *
      * @param mana A reference to a unique_ptr of Mana.
      */
     void setTapped(std::unique_ptr<Mana> &mana)
     {
-        mana->increaseManaWithTap(cardName);
-        hasTapped = true;
-    }
-
-    /**
-     * @brief Checks if the land card has been tapped.
-     *
-     * @return true if the land card has been tapped, false otherwise.
-     */
-    bool hasTappedInfo() { return hasTapped; }
-
-    /**
-     * @brief Checks if the land card is a mana card.
-     *
-     * @return true if the land card is a mana card, false otherwise.
-     */
-    bool isManaE() { return true; }
-}; // LandCard class
-//======================================================================================================================
-/**
- * @brief The CreatureCard class represents a card that is a creature in a card game.
- *
- * It inherits from the Card class and adds additional properties and methods specific to creature cards.
- */
-class CreatureCard : public Card
-{
-protected:
-    std::string manaCost;
-    int attackPower;
-    int baseHP;
-    int hp = baseHP;
-    bool baseFirstStrike;
-    bool baseTrample;
-    bool hasTapped;
-    bool firstStrike = baseFirstStrike;
-    bool trample = baseTrample;
-
-public:
-    CreatureCard() : Card(), attackPower(0), baseHP(0), manaCost(" "), baseFirstStrike(0), baseTrample(0)
-    {
-    }
-    CreatureCard(std::string cardName, std::string type, std::string color, int attack, int hp, std::string cost, bool firstStrike, bool trample) : Card(cardName, type, color), attackPower(attack), baseHP(hp), manaCost(cost), baseFirstStrike(firstStrike), baseTrample(trample)
-    {
-    }
-
-    void play(std::unique_ptr<Mana> &mana) { mana->cost(cardName); }
-
-    void printCardName() { std::cout << cardName; }
-    void BoostStats()
-    {
-        attackPower++;
-        hp++;
-    }
-    void DecreaseStats()
-    {
-        attackPower--;
-        hp--;
-    }
-    void BoostAttack() { attackPower += 2; }
-
-    void reverseHolyWar()
-    {
-        attackPower--;
-        hp--;
-    }
-    void reverseHolylight()
-    {
-        attackPower++;
-        hp++;
-    }
-    void reverseUnholyWar()
-    {
-        if (attackPower == 0 || attackPower < 0)
+        if (kind == CardKind::Land)
         {
-        }
-        else if (attackPower == 1)
-        {
-            attackPower--;
-        }
-        else
-        {
-            attackPower -= 2;
+            mana->increaseManaWithTap(cardName);
+            hasTapped = true;
         }
     }
 
-    void deal1Dmg() { hp--; }
-    void deal2Dmg() { hp -= 2; }
-
-    int dealAttack() { return attackPower; }
-
-    void setUntapped() { hasTapped = false; }
-    void setTapped() { hasTapped = true; }
-
-    void setFirstStrike() { firstStrike = true; }
-    void setTrample() { trample = true; }
+    void setFirstStrike() { firstStrike = isCreature(); }
+    void setTrample() { trample = isCreature(); }
     void removeTrample() { trample = false; }
     void removeFirstStrike() { firstStrike = false; }
-    bool getFirstStrike() { return firstStrike; }
-    bool getTrample() { return trample; }
+    bool getFirstStrike() const { return firstStrike; }
+    bool getTrample() const { return trample; }
 
     void trampleBase() { trample = baseTrample; }
     void firstStrikeBase() { firstStrike = baseFirstStrike; }
 
     void goBaseHp() { hp = baseHP; }
 
-    bool hasTappedInfo() { return hasTapped; }
-
-    bool isManaE(std::unique_ptr<Mana> &mana) { return mana->isManaEnough(cardName); }
+    bool hasTappedInfo() const { return hasTapped; }
 
-    int getHp() { return hp; }
-    int getAttackPower() { return attackPower; }
-    void sustainDamage(int dmg) { hp -= dmg; }
-    bool checkDead()
+    /**
+     * @brief Plays the card, paying its mana cost.
+     *
+     * @param mana A reference to a unique_ptr of Mana.
+     */
+    void play(std::unique_ptr<Mana> &mana)
     {
-        if (hp < 1)
+        if (kind == CardKind::Land)
         {
-            return true;
+            std::cout << "land card play function ";
         }
-        else
+        mana->cost(cardName);
+    }
+
+    bool isManaE(std::unique_ptr<Mana> &mana) { return mana->isManaEnough(cardName); }
+
+    int getHp() const { return hp; }
+    int getAttackPower() const { return attackPower; }
+    void sustainDamage(int dmg)
+    {
+        if (isCreature())
         {
-            return false;
+            hp -= dmg;
         }
     }
-}; // CreatureCard class
+    bool checkDead() const { return isCreature() && hp < 1; }
+}; // Card class
+//----------------------------------------------------------------------------------------------------------------------
+// A hand of the interactive game, held inline up to the standard hand limit
+using Hand = StaticVector<Card, StandardRules.handLimit>;
 //======================================================================================================================
 /**
- * @brief The SorceryCard class represents a sorcery card in a card game.
+ * @brief The LandCard class represents a land card in a card game.
  *
- * It inherits from the Card class and adds additional properties and methods specific to sorcery cards.
+ * It builds a Card of the Land kind. Lands produce mana when they are tapped.
  */
-class SorceryCard : public Card
+class LandCard : public Card
 {
-
-protected:
-    std::string effect2, manaCost2;
-
 public:
     /**
-     * @brief Default constructor for SorceryCard.
-     */
-    SorceryCard() : Card(), manaCost2(" "), effect2(" ") {}
-
-    /**
-     * @brief Constructor for SorceryCard.
-     *
-     * @param cN2 The name of the sorcery card.
-     * @param cC2 The color of the sorcery card.
-     * @param mC2 The mana cost of the sorcery card.
-     * @param ef2 The effect of the sorcery card.
-     */
-    SorceryCard(std::string cN2, std::string cC2, std::string mC2, std::string ef2) : Card(cN2, "SorceryCard", cC2), manaCost2(mC2), effect2(ef2) {}
-
-    /**
-     * @brief Prints the name of the sorcery card.
+     * @brief Default constructor for LandCard.
      */
-    void printCardName() { std::cout << cardName; }
+    LandCard() : Card(CardKind::Land, "", "", "") {}
 
     /**
-     * @brief Plays the sorcery card using the provided mana.
+     * @brief Constructor for LandCard with specified parameters.
      *
-     * @param mana A reference to the mana object.
+     * @param cN The name of the card.
+     * @param t The type of the card.
+     * @param hT A boolean indicating whether the card has been tapped.
      */
-    void play(std::unique_ptr<Mana> &mana) { mana->cost(cardName); }
+    LandCard(const char *cN, const char *t, bool hT) : Card(CardKind::Land, cN, t, " ") { hasTapped = hT; }
+}; // LandCard class
+//======================================================================================================================
+/**
+ * @brief The CreatureCard class represents a card that is a creature in a card game.
+ *
+ * It builds a Card of the Creature kind with its attack power, hp, mana cost and base abilities.
+ */
+class CreatureCard : public Card
+{
+public:
+    CreatureCard() : Card(CardKind::Creature, "", "", "") { manaCost = " "; }
+    CreatureCard(const char *cardName, const char *type, const char *color, int attack, int hp, const char *cost, bool firstStrike, bool trample) : Card(CardKind::Creature, cardName, type, color)
+    {
+        manaCost = cost;
+        attackPower = attack;
+        this->baseHP = this->hp = hp;
+        this->baseFirstStrike = this->firstStrike = firstStrike;
+        this->baseTrample = this->trample = trample;
+    }
+}; // CreatureCard class
+//======================================================================================================================
+/**
+ * @brief The SorceryCard class represents a sorcery card in a card game.
+ *
+ * It builds a Card of the Sorcery kind with its mana cost and effect text.
+ */
+class SorceryCard : public Card
+{
+public:
+    /**
+     * @brief Default constructor for SorceryCard.
+     */
+    SorceryCard() : Card(CardKind::Sorcery, "", "SorceryCard", "")
+    {
+        manaCost = " ";
+        effect = " ";
+    }
 
     /**
-     * @brief Checks if the mana is enough to play the sorcery card.
+     * @brief Constructor for SorceryCard.
      *
-     * @param mana A reference to the mana object.
-     * @return True if the mana is enough, false otherwise.
+     * @param cN2 The name of the sorcery card.
+     * @param cC2 The color of the sorcery card.
+     * @param mC2 The mana cost of the sorcery card.
+     * @param ef2 The effect of the sorcery card.
      */
-    bool isManaE(std::unique_ptr<Mana> &mana) { return mana->isManaEnough(cardName); }
+    SorceryCard(const char *cN2, const char *cC2, const char *mC2, const char *ef2) : Card(CardKind::Sorcery, cN2, "SorceryCard", cC2)
+    {
+        manaCost = mC2;
+        effect = ef2;
+    }
 }; // SorceryCard class
 //======================================================================================================================
 /**
  * @class EnhancementCard
  * @brief Represents an enhancement card in a card game.
  *
- * This class inherits from the Card class and adds additional properties and methods specific to enhancement cards.
+ * It builds a Card of the Enhancement kind with its mana cost and effect text.
  */
 class EnhancementCard : public Card
 {
-
-protected:
-    std::string effect2, manaCost2;
-
 public:
-    EnhancementCard() : Card(), manaCost2(" "), effect2(" ") {}
-    EnhancementCard(std::string cN2, std::string cC2, std::string mC2, std::string ef2) : Card(cN2, "EnhancementCard", cC2), manaCost2(mC2), effect2(ef2) {}
-
-    void printCardName() { std::cout << cardName; }
-    void play(std::unique_ptr<Mana> &mana) { mana->cost(cardName); }
-    bool isManaE(std::unique_ptr<Mana> &mana) { return mana->isManaEnough(cardName); }
+    EnhancementCard() : Card(CardKind::Enhancement, "", "EnhancementCard", "")
+    {
+        manaCost = " ";
+        effect = " ";
+    }
+    EnhancementCard(const char *cN2, const char *cC2, const char *mC2, const char *ef2) : Card(CardKind::Enhancement, cN2, "EnhancementCard", cC2)
+    {
+        manaCost = mC2;
+        effect = ef2;
+    }
 }; // EnhancementCard class
+static_assert(sizeof(LandCard) == sizeof(Card) && sizeof(CreatureCard) == sizeof(Card) && sizeof(SorceryCard) == sizeof(Card) && sizeof(EnhancementCard) == sizeof(Card), "card kinds add no state and are stored as a Card");
+static_assert(std::is_trivially_copyable<Card>::value, "cards move between zones without allocating");
 //======================================================================================================================
 /**
  * @class Player
@@ -666,32 +656,30 @@ class Player
 {
 
 protected:
-    int hp = 15;
+    int hp = StandardRules.startingHp;
 
-    std::vector<std::shared_ptr<Card>> library;
-    std::vector<std::shared_ptr<Card>> libraryx;
-    std::vector<std::shared_ptr<Card>> hand;
-    std::vector<std::shared_ptr<Card>> inPlay;
-    std::vector<std::shared_ptr<Card>> discard;
+    std::vector<Card> library;
+    std::vector<Card> libraryx;
+    Hand hand;
+    std::vector<Card> inPlay;
+    std::vector<Card> discard;
 
 public:
     Player() {}
-    Player(std::vector<std::shared_ptr<Card>> &lib, std::vector<std::shared_ptr<Card>> &hnd, std::vector<std::shared_ptr<Card>> &iP, std::vector<std::shared_ptr<Card>> &dc) : library(lib), hand(hnd), inPlay(iP), discard(dc) { libaryRandomizeAndHand7Initialy(lib, hnd); }
-    //----------------------------------------------------------------------------------------------------------------------
-    void deal2Dmg() { hp -= 2; }
+    Player(std::vector<Card> &lib, Hand &hnd, std::vector<Card> &iP, std::vector<Card> &dc) : library(lib), hand(hnd), inPlay(iP), discard(dc) { libaryRandomizeAndHand7Initialy(lib, hnd); }
     //----------------------------------------------------------------------------------------------------------------------
     /**
-     * Randomizes the cards in the library and deals 7 cards to the hand.
+     * Randomizes the cards in the library and deals the opening hand.
      *
      * @param lib The library of cards.
      * @param hnd The hand of cards.
      */
-    void libaryRandomizeAndHand7Initialy(std::vector<std::shared_ptr<Card>> &lib, std::vector<std::shared_ptr<Card>> &hnd)
+    void libaryRandomizeAndHand7Initialy(std::vector<Card> &lib, Hand &hnd)
     {
 
-        int a[26];
+        int a[StandardRules.deckSize];
 
-        for (int i = 0; i < 26; i++)
+        for (int i = 0; i < StandardRules.deckSize; i++)
         {
             bool isUsedBefore = false;
             a[i] = (rand() % library.size());
@@ -716,9 +704,9 @@ public:
 
         lib = library = libraryx;
 
-        for (int i = 0; i < 5; i++)
+        for (int i = 0; i < StandardRules.openingHand; i++)
         {
-            hnd.emplace_back(lib[lib.size() - 1]);
+            hnd.push_back(lib[lib.size() - 1]);
             lib.pop_back();
         }
     }
@@ -764,15 +752,7 @@ public:
      * @param discard The discard pile.
      * @param s The type of card to destroy.
      */
-    void destroyCardEffectFunc(std::vector<std::shared_ptr<Card>> &ip, std::vector<std::shared_ptr<Card>> &discard, std::string s)
-    {
-        // Implementation code...
-    }
-}; // DestroyCardEffect class
-class DestroyCardEffect : public Effect
-{
-public:
-    void destroyCardEffectFunc(std::vector<std::shared_ptr<Card>> &ip, std::vector<std::shared_ptr<Card>> &discard, std::string s)
+    void destroyCardEffectFunc(std::vector<Card> &ip, std::vector<Card> &discard, std::string_view s)
     {
 
         auto it = ip.begin();
@@ -783,7 +763,7 @@ public:
 
             for (it = ip.begin(); it != ip.end(); it++)
             {
-                if ((*it)->getCardtype() == "EnhancementCard")
+                if (it->getCardtype() == "EnhancementCard")
                 {
                     isThereDestroyable = true;
                 }
@@ -796,67 +776,20 @@ public:
 
                 for (it = ip.begin(); it != ip.end(); it++)
                 {
-                    if ((*it)->getCardtype() == "EnhancementCard")
+                    if (it->getCardtype() == "EnhancementCard")
                     {
                         std::cout << i << ")" << std::endl;
                         i++;
-                        (*it)->printCardName();
+                        it->printCardName();
                     }
                 }
                 std::cin >> i;
 
-                std::cout << "opponent's " << ip[i]->getCardName()
+                std::cout << "opponent's " << ip[i].getCardName()
                           << " enhancement card has been destroyed and because of it is an enhancement card its effects are reversed and canceled "
                           << std::endl;
 
-                std::string namen;
-                namen = ip[i]->getCardName();
-
-                if (namen == "Rage")
-                {
-                    for (it = ip.begin(); it != ip.end(); it++)
-                    {
-                        (*it)->trampleBase();
-                    }
-                }
-
-                else if (namen == "HolyWar")
-                {
-                    for (it = ip.begin(); it != ip.end(); it++)
-                    {
-                        (*it)->reverseHolyWar();
-                    }
-                }
-
-                else if (namen == "HolyLight")
-                {
-                    for (it = ip.begin(); it != ip.end(); it++)
-                    {
-                        (*it)->reverseHolylight();
-                    }
-                }
-                else if (namen == "UnholyWar")
-                {
-                    for (it = ip.begin(); it != ip.end(); it++)
-                    {
-                        (*it)->reverseUnholyWar();
-                    }
-                }
-                else if (namen == "Restrain")
-                {
-                    for (it = ip.begin(); it != ip.end(); it++)
-                    {
-                        if ((*it)->getCardColor() == "Green")
-                            (*it)->trampleBase();
-                    }
-                }
-                else if (namen == "Slow")
-                {
-                    for (it = ip.begin(); it != ip.end(); it++)
-                    {
-                        (*it)->trampleBase();
-                    }
-                }
+                reverseEnhancement(ip, ip[i].getCardName());
 
                 discard.emplace_back(ip[i]);
                 ip.erase(ip.begin() + i);
@@ -873,7 +806,7 @@ public:
         {
             for (it = ip.begin(); it != ip.end(); it++)
             {
-                if ((*it)->getCardtype() == "LandCard")
+                if (it->getCardtype() == "LandCard")
                 {
                     isThereDestroyable = true;
                 }
@@ -887,16 +820,16 @@ public:
 
                 for (it = ip.begin(); it != ip.end(); it++)
                 {
-                    if ((*it)->getCardtype() == "LandCard")
+                    if (it->getCardtype() == "LandCard")
                     {
                         std::cout << i << ")" << std::endl;
                         i++;
-                        (*it)->printCardName();
+                        it->printCardName();
                     }
                 }
                 std::cin >> i;
 
-                std::cout << "opponent's " << ip[i]->getCardName() << " land card has been destroyed" << std::endl;
+                std::cout << "opponent's " << ip[i].getCardName() << " land card has been destroyed" << std::endl;
 
                 discard.emplace_back(ip[i]);
                 ip.erase(ip.begin() + i);
@@ -913,7 +846,7 @@ public:
         {
             for (it = ip.begin(); it != ip.end(); it++)
             {
-                if ((*it)->getCardtype() == "CreatureCard")
+                if (it->getCardtype() == "CreatureCard")
                 {
                     isThereDestroyable = true;
                 }
@@ -927,16 +860,16 @@ public:
 
                 for (it = ip.begin(); it != ip.end(); it++)
                 {
-                    if ((*it)->getCardtype() == "CreatureCard")
+                    if (it->getCardtype() == "CreatureCard")
                     {
                         std::cout << i << ")" << std::endl;
                         i++;
-                        (*it)->printCardName();
+                        it->printCardName();
                     }
                 }
                 std::cin >> i;
 
-                std::cout << "opponent's " << ip[i]->getCardName() << " creature card has been destroyed" << std::endl;
+                std::cout << "opponent's " << ip[i].getCardName() << " creature card has been destroyed" << std::endl;
 
                 discard.emplace_back(ip[i]);
                 ip.erase(ip.begin() + i);
@@ -950,113 +883,34 @@ public:
             }
         }
     }
+
+private:
+    // Takes back what a destroyed enhancement did to the creatures in ip; its effect and amounts are read from the
+    // active pool, so it is defined once the pool exists
+    void reverseEnhancement(std::vector<Card> &ip, std::string_view enhancement);
 }; // DestroyCardEffect class
 //======================================================================================================================
 // Effect card stats
 class EffectForColorEffect : public Effect
 {
 public:
-    void effectThatColorMembers(std::vector<std::shared_ptr<Card>> &ip, std::string s)
-    {
-
-        auto it = ip.begin();
-
-        if (s == "HolyWar")
-        {
-            for (it = ip.begin(); it != ip.end(); it++)
-            {
-                if ((*it)->getCardColor() == "White")
-                {
-                    (*it)->BoostStats();
-                }
-            }
-            std::cout << "all white creature cards in your side that in play gain +1/+1 " << std::endl;
-        }
-
-        else if (s == "HolyLight")
-        {
-            for (it = ip.begin(); it != ip.end(); it++)
-            {
-                if ((*it)->getCardColor() == "Black")
-                {
-                    (*it)->DecreaseStats();
-                }
-            }
-            std::cout << "all black creature cards in your side that in play gain -1/-1 " << std::endl;
-        }
-
-        else if (s == "UnholyWar")
-        {
-            for (it = ip.begin(); it != ip.end(); it++)
-            {
-                if ((*it)->getCardColor() == "Black")
-                {
-                    (*it)->BoostAttack();
-                }
-            }
-            std::cout << "all black creature cards in your side that in play gain +2/0 " << std::endl;
-        }
-    }
+    // Applies HolyWar, HolyLight or UnholyWar with the amounts of the active pool, so it is defined once the pool exists
+    void effectThatColorMembers(std::vector<Card> &ip, std::string_view s);
 }; // EffectForColorEffect class
 //======================================================================================================================
 // Effect for dealing damage
 class DealDamageEffect : public Effect
 {
 public:
-    void dealDamage(std::vector<std::shared_ptr<Card>> &ip, std::string n, std::unique_ptr<Player> &player)
-    {
-        auto it = ip.begin();
-        if (n == "Plague")
-        {
-            for (it = ip.begin(); it != ip.end(); it++)
-            {
-                (*it)->deal1Dmg();
-            }
-            std::cout << "all opponent's creature cards dealt 1 damage " << std::endl;
-        }
-
-        else if (n == "LightningBolt")
-        {
-
-            std::cout << "please choose given options below and type its number" << std::endl;
-            std::cout << "1)Deal damage to player" << std::endl;
-            std::cout << "2)Deal damage to target creature card" << std::endl;
-
-            int a;
-
-            std::cin >> a;
-
-            if (a == 1)
-            {
-                player->deal2Dmg();
-                std::cout << "dealt 2 damage to the opponent player" << std::endl;
-            }
-
-            else if (a == 2)
-            {
-                for (it = ip.begin(); it != ip.end(); it++)
-                {
-                    if ((*it)->getCardtype() == "CreatureCard")
-                    {
-                        (*it)->deal2Dmg();
-                        std::cout << "dealt " << (*it)->getCardName() << " 2 damage " << std::endl;
-                    }
-                }
-            }
-
-            else
-            {
-                std::cout << "YOU HAVE MISSED YOUR CHANCE " << std::endl;
-            }
-        }
-    }
+    // Applies Plague or LightningBolt with the damage of the active pool, so it is defined once the pool exists
+    void dealDamage(std::vector<Card> &ip, std::string_view n, std::unique_ptr<Player> &player);
 }; // DealDamageEffect class
 //======================================================================================================================
 // Reanimate effect
 class ReviveFromGraveEffect : public Effect
 {
 public:
-    void revive(std::vector<std::shared_ptr<Card>> &discard, std::vector<std::shared_ptr<Card>> &hand)
+    void revive(std::vector<Card> &discard, Hand &hand)
     {
 
         auto it = discard.begin();
@@ -1066,6 +920,10 @@ public:
         {
             std::cout << "you dont have any card in discard pile you have missed your chance" << std::endl;
         }
+        else if (hand.full())
+        {
+            std::cout << "Your hand is full. You can not play this card." << std::endl;
+        }
         else
         {
             std::cout << "Choose 1 creature card from your discard pile. " << std::endl;
@@ -1076,25 +934,17 @@ public:
             {
                 for (it = discard.begin(); it != discard.end(); it++)
                 {
-                    if (hand.size() < 7)
-                    {
-
-                        std::cout << temp << ")";
-                        (*it)->printCardName();
-                        temp++;
-                    }
-                    else
-                    {
-                        std::cout << "Your hand is full. You can not play this card." << std::endl;
-                    }
+                    std::cout << temp << ")";
+                    it->printCardName();
+                    temp++;
                 }
 
                 std::cin >> temp;
-                if (discard[temp]->getCardtype() == "CreatureCard")
+                if (discard[temp].getCardtype() == "CreatureCard")
                 {
-                    hand.emplace_back(discard[temp]);
+                    hand.push_back(discard[temp]);
                     discard.erase(discard.begin() + temp);
-                    std::cout << (*it)->getCardName() << " card has moved to your hand." << std::endl;
+                    std::cout << it->getCardName() << " card has moved to your hand." << std::endl;
                     a = true;
                 }
                 else
@@ -1110,7 +960,7 @@ public:
 class AbilityEffect : public Effect
 {
 public:
-    void effectAbility(std::vector<std::shared_ptr<Card>> &ip, std::string n)
+    void effectAbility(std::vector<Card> &ip, std::string_view n)
     {
         auto it = ip.begin();
         int tmp = 0;
@@ -1119,10 +969,10 @@ public:
         {
             for (it = ip.begin(); it != ip.end(); it++)
             {
-                if ((*it)->getCardColor() == "Green")
+                if (it->getCardColor() == "Green")
                 {
-                    (*it)->removeTrample();
-                    std::cout << (*it)->getCardName() << "'s trample ability removed " << std::endl;
+                    it->removeTrample();
+                    std::cout << it->getCardName() << "'s trample ability removed " << std::endl;
                 }
             }
         }
@@ -1135,17 +985,17 @@ public:
             {
                 for (it = ip.begin(); it != ip.end(); it++)
                 {
-                    if ((*it)->getCardtype() == "CreatureCard")
+                    if (it->getCardtype() == "CreatureCard")
                     {
                         std::cout << tmp << ")";
-                        (*it)->printCardName();
+                        it->printCardName();
                         tmp++;
                         std::cin >> tmp;
 
-                        if ((*it)->getCardtype() == "CreatureCard")
+                        if (it->getCardtype() == "CreatureCard")
                         {
-                            (*it)->setTrample();
-                            std::cout << (*it)->getCardName() << " gain trample ability " << std::endl;
+                            it->setTrample();
+                            std::cout << it->getCardName() << " gain trample ability " << std::endl;
                             a = true;
                         }
                         else
@@ -1169,17 +1019,17 @@ public:
             {
                 for (it = ip.begin(); it != ip.end(); it++)
                 {
-                    if ((*it)->getCardtype() == "CreatureCard")
+                    if (it->getCardtype() == "CreatureCard")
                     {
                         std::cout << tmp << ")";
-                        (*it)->printCardName();
+                        it->printCardName();
                         tmp++;
                         std::cin >> tmp;
 
-                        if ((*it)->getCardtype() == "CreatureCard")
+                        if (it->getCardtype() == "CreatureCard")
                         {
-                            (*it)->removeFirstStrike();
-                            std::cout << (*it)->getCardName() << "'s first strike ability removed " << std::endl;
+                            it->removeFirstStrike();
+                            std::cout << it->getCardName() << "'s first strike ability removed " << std::endl;
                             a = true;
                         }
                         else
@@ -1221,277 +1071,8259 @@ void printLoser(std::unique_ptr<Player> &player1, std::unique_ptr<Player> &playe
 } // printLoser function
 //----------------------------------------------------------------------------------------------------------------------
 // Untap cards function
-void untapped(std::vector<std::shared_ptr<Card>> &ip, std::vector<std::shared_ptr<Card>> &l, std::vector<std::shared_ptr<Card>> &d, std::vector<std::shared_ptr<Card>> &h)
+void untapped(std::vector<Card> &ip, std::vector<Card> &l, std::vector<Card> &d, Hand &h)
 {
     auto it = ip.begin();
 
     for (it = ip.begin(); it != ip.end(); it++)
     {
-        (*it)->setUntapped();
+        it->setUntapped();
     }
     for (it = l.begin(); it != l.end(); it++)
     {
-        (*it)->setUntapped();
+        it->setUntapped();
     }
     for (it = d.begin(); it != d.end(); it++)
     {
-        (*it)->setUntapped();
+        it->setUntapped();
     }
-    for (it = h.begin(); it != h.end(); it++)
+    for (Card &card : h)
     {
-        (*it)->setUntapped();
+        card.setUntapped();
     }
 } // untapped function
 //----------------------------------------------------------------------------------------------------------------------
 // Return creature card's hp to their baseHP
-void baseHp(std::vector<std::shared_ptr<Card>> &ip, std::vector<std::shared_ptr<Card>> &l, std::vector<std::shared_ptr<Card>> &d, std::vector<std::shared_ptr<Card>> &h)
+void baseHp(std::vector<Card> &ip, std::vector<Card> &l, std::vector<Card> &d, Hand &h)
 {
     auto it = ip.begin();
 
     for (it = ip.begin(); it != ip.end(); it++)
     {
-        (*it)->goBaseHp();
+        it->goBaseHp();
     }
     for (it = l.begin(); it != l.end(); it++)
     {
-        (*it)->goBaseHp();
+        it->goBaseHp();
     }
     for (it = d.begin(); it != d.end(); it++)
     {
-        (*it)->goBaseHp();
+        it->goBaseHp();
     }
-    for (it = h.begin(); it != h.end(); it++)
+    for (Card &card : h)
     {
-        (*it)->goBaseHp();
+        card.goBaseHp();
     }
 } // baseHp function
 //----------------------------------------------------------------------------------------------------------------------
 // Attack function of creature cards
-void combat(std::vector<std::shared_ptr<Card>> &attackerInplay, int i, std::vector<std::shared_ptr<Card>> &defenderInplay, int o, std::unique_ptr<Player> &playerOp, std::vector<std::shared_ptr<Card>> &dc1, std::vector<std::shared_ptr<Card>> &dc2)
+void combat(std::vector<Card> &attackerInplay, int i, std::vector<Card> &defenderInplay, int o, std::unique_ptr<Player> &playerOp, std::vector<Card> &dc1, std::vector<Card> &dc2)
 {
 
     int excessAttackPower;
 
-    if (defenderInplay[o]->getCardtype() == "CreatureCard")
+    if (defenderInplay[o].getCardtype() == "CreatureCard")
     {
 
-        if (attackerInplay[i]->getFirstStrike())
+        if (attackerInplay[i].getFirstStrike())
         {
-            defenderInplay[o]->sustainDamage(attackerInplay[i]->getAttackPower());
-            std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
+            defenderInplay[o].sustainDamage(attackerInplay[i].getAttackPower());
+            std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
 
-            if (defenderInplay[o]->checkDead())
+            if (defenderInplay[o].checkDead())
             {
-                std::cout << defenderInplay[o]->getCardName() << " is destroyed " << std::endl;
+                std::cout << defenderInplay[o].getCardName() << " is destroyed " << std::endl;
                 dc2.emplace_back(defenderInplay[o]);
                 defenderInplay.erase(defenderInplay.begin() + o);
             }
 
-            if (attackerInplay[i]->getAttackPower() < defenderInplay[o]->getHp())
+            if (attackerInplay[i].getAttackPower() < defenderInplay[o].getHp())
             {
-                attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-                std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
+                attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+                std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
 
-                if (attackerInplay[i]->checkDead())
+                if (attackerInplay[i].checkDead())
                 {
-                    std::cout << attackerInplay[i]->getCardName() << " is destroyed " << std::endl;
+                    std::cout << attackerInplay[i].getCardName() << " is destroyed " << std::endl;
                     dc1.emplace_back(attackerInplay[i]);
                     attackerInplay.erase(attackerInplay.begin() + i);
                 }
             }
         }
 
-        else if (defenderInplay[o]->getFirstStrike())
+        else if (defenderInplay[o].getFirstStrike())
         {
-            attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-            std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
+            attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+            std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
 
-            if (attackerInplay[i]->checkDead())
+            if (attackerInplay[i].checkDead())
             {
-                std::cout << attackerInplay[i]->getCardName() << " is destroyed " << std::endl;
+                std::cout << attackerInplay[i].getCardName() << " is destroyed " << std::endl;
                 dc1.emplace_back(attackerInplay[i]);
                 attackerInplay.erase(attackerInplay.begin() + i);
             }
-            if (defenderInplay[o]->getAttackPower() < attackerInplay[i]->getHp())
+            if (defenderInplay[o].getAttackPower() < attackerInplay[i].getHp())
             {
-                defenderInplay[o]->sustainDamage(attackerInplay[i]->getAttackPower());
-                std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
+                defenderInplay[o].sustainDamage(attackerInplay[i].getAttackPower());
+                std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
 
-                if (defenderInplay[o]->checkDead())
+                if (defenderInplay[o].checkDead())
                 {
-                    std::cout << defenderInplay[o]->getCardName() << " is destroyed " << std::endl;
+                    std::cout << defenderInplay[o].getCardName() << " is destroyed " << std::endl;
                     dc2.emplace_back(defenderInplay[o]);
                     defenderInplay.erase(defenderInplay.begin() + o);
                 }
             }
         }
 
-        else if (attackerInplay[i]->getFirstStrike() && defenderInplay[o]->getFirstStrike())
+        else if (attackerInplay[i].getFirstStrike() && defenderInplay[o].getFirstStrike())
         {
-            defenderInplay[o]->sustainDamage(attackerInplay[i]->getAttackPower());
-            std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
+            defenderInplay[o].sustainDamage(attackerInplay[i].getAttackPower());
+            std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
 
-            attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-            std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
+            attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+            std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
 
-            if (defenderInplay[o]->checkDead())
+            if (defenderInplay[o].checkDead())
             {
-                std::cout << defenderInplay[o]->getCardName() << " is destroyed " << std::endl;
+                std::cout << defenderInplay[o].getCardName() << " is destroyed " << std::endl;
                 dc2.emplace_back(defenderInplay[o]);
                 defenderInplay.erase(defenderInplay.begin() + o);
             }
-            if (attackerInplay[i]->checkDead())
+            if (attackerInplay[i].checkDead())
             {
-                std::cout << attackerInplay[i]->getCardName() << " is destroyed " << std::endl;
+                std::cout << attackerInplay[i].getCardName() << " is destroyed " << std::endl;
                 dc1.emplace_back(attackerInplay[i]);
                 attackerInplay.erase(attackerInplay.begin() + i);
             }
         }
 
-        else if (attackerInplay[i]->getTrample())
+        else if (attackerInplay[i].getTrample())
         {
-            defenderInplay[o]->sustainDamage(defenderInplay[o]->getAttackPower());
-            std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
+            defenderInplay[o].sustainDamage(defenderInplay[o].getAttackPower());
+            std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
 
-            attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-            std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
+            attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+            std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
 
-            if (attackerInplay[i]->getAttackPower() > defenderInplay[o]->getHp())
+            if (attackerInplay[i].getAttackPower() > defenderInplay[o].getHp())
             {
-                excessAttackPower = attackerInplay[i]->getAttackPower() - defenderInplay[o]->getHp();
+                excessAttackPower = attackerInplay[i].getAttackPower() - defenderInplay[o].getHp();
                 playerOp->susDamage(excessAttackPower);
                 std::cout << "Because of attacker card's trample ability " << excessAttackPower << " dealt to opponent player " << std::endl;
             }
         }
 
-        else if (defenderInplay[o]->getTrample())
+        else if (defenderInplay[o].getTrample())
+        {
+            defenderInplay[o].sustainDamage(attackerInplay[i].getAttackPower());
+            std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
+
+            attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+            std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
+
+            if (defenderInplay[o].checkDead())
+            {
+                std::cout << defenderInplay[o].getCardName() << " is destroyed " << std::endl;
+                dc2.emplace_back(defenderInplay[o]);
+                defenderInplay.erase(defenderInplay.begin() + o);
+            }
+            if (attackerInplay[i].checkDead())
+            {
+                std::cout << attackerInplay[i].getCardName() << " is destroyed " << std::endl;
+                dc1.emplace_back(attackerInplay[i]);
+                attackerInplay.erase(attackerInplay.begin() + i);
+            }
+        }
+
+        else if (attackerInplay[i].getFirstStrike() && attackerInplay[i].getTrample())
+        {
+            defenderInplay[o].sustainDamage(attackerInplay[i].getAttackPower());
+            std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
+
+            if (defenderInplay[o].checkDead())
+            {
+                std::cout << defenderInplay[o].getCardName() << " is destroyed " << std::endl;
+                dc2.emplace_back(defenderInplay[o]);
+                defenderInplay.erase(defenderInplay.begin() + o);
+            }
+
+            if (attackerInplay[i].getAttackPower() < defenderInplay[o].getHp())
+            {
+                attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+                std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
+
+                if (attackerInplay[i].getAttackPower() > defenderInplay[o].getHp())
+                {
+                    excessAttackPower = attackerInplay[i].getAttackPower() - defenderInplay[o].getHp();
+                    playerOp->susDamage(excessAttackPower);
+                    std::cout << "Because of attacker card's trample ability " << excessAttackPower << " dealt to opponent player " << std::endl;
+                }
+            }
+        }
+
+        else
+        {
+            defenderInplay[o].sustainDamage(attackerInplay[i].getAttackPower());
+            std::cout << attackerInplay[i].getCardName() << " hit " << attackerInplay[i].getAttackPower() << " damage to " << defenderInplay[o].getCardName() << std::endl;
+
+            attackerInplay[i].sustainDamage(defenderInplay[o].getAttackPower());
+            std::cout << defenderInplay[o].getCardName() << " hit " << defenderInplay[o].getAttackPower() << " damage to " << attackerInplay[o].getCardName() << std::endl;
+
+            if (defenderInplay[o].checkDead())
+            {
+                std::cout << defenderInplay[o].getCardName() << " is destroyed " << std::endl;
+                dc2.emplace_back(defenderInplay[o]);
+                defenderInplay.erase(defenderInplay.begin() + o);
+            }
+            if (attackerInplay[i].checkDead())
+            {
+                std::cout << attackerInplay[i].getCardName() << " is destroyed " << std::endl;
+                dc1.emplace_back(attackerInplay[i]);
+                attackerInplay.erase(attackerInplay.begin() + i);
+            }
+        }
+    }
+    else
+    {
+        std::cout << "Player take " << attackerInplay[i].getAttackPower() << " damage" << std::endl;
+        playerOp->susDamage(attackerInplay[i].getAttackPower());
+    }
+} // combat function
+//----------------------------------------------------------------------------------------------------------------------
+// For print the cards in inPlay
+void printInPlay(std::vector<Card> &ip)
+{
+    auto it = ip.begin();
+    int counter = 0;
+    std::cout << " cards that in play: " << std::endl;
+    for (it = ip.begin(); it != ip.end(); it++)
+    {
+        std::cout << counter << ")" << it->getCardName() << "  ";
+        counter++;
+    }
+} // printInPlay function
+//----------------------------------------------------------------------------------------------------------------------
+// For print the cards in hand
+void printHand(Hand &hand)
+{
+    auto it = hand.begin();
+    int counter = 0;
+    std::cout << " cards that in hand: " << std::endl;
+    for (it = hand.begin(); it != hand.end(); it++)
+    {
+        std::cout << counter << ")" << it->getCardName() << "  ";
+        counter++;
+    }
+} // printHand function
+//======================================================================================================================
+/**
+ * @struct CreatureStats
+ * @brief The combat relevant stats of a single creature card.
+ */
+struct CreatureStats
+{
+    int attack;
+    int hp;
+    bool firstStrike;
+    bool trample;
+}; // CreatureStats struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct CombatOutcome
+ * @brief The result of one attacker being blocked by one defender.
+ */
+struct CombatOutcome
+{
+    bool attackerDies;
+    bool blockerDies;
+    int attackerHpLeft;
+    int blockerHpLeft;
+    int trampleDamage; // damage that goes over the blocker to the defending player
+}; // CombatOutcome struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Resolves a single attacker versus blocker fight without touching any card.
+ *
+ * First strike damage is dealt before normal damage, so a first striker that kills its opponent takes no damage back.
+ * If both or neither have first strike the damage is dealt at the same time. A trampling attacker that survives long
+ * enough to hit deals its attack power above the blocker's hp to the defending player.
+ *
+ * @param attacker Stats of the attacking creature.
+ * @param blocker Stats of the blocking creature.
+ * @return The outcome of the fight.
+ */
+constexpr CombatOutcome simulateCombat(const CreatureStats &attacker, const CreatureStats &blocker)
+{
+    int attackerHp = attacker.hp;
+    int blockerHp = blocker.hp;
+    bool attackerHits = true;
+
+    if (attacker.firstStrike && !blocker.firstStrike)
+    {
+        blockerHp -= attacker.attack;
+        if (blockerHp > 0)
+        {
+            attackerHp -= blocker.attack;
+        }
+    }
+    else if (blocker.firstStrike && !attacker.firstStrike)
+    {
+        attackerHp -= blocker.attack;
+        if (attackerHp > 0)
+        {
+            blockerHp -= attacker.attack;
+        }
+        else
+        {
+            attackerHits = false;
+        }
+    }
+    else
+    {
+        blockerHp -= attacker.attack;
+        attackerHp -= blocker.attack;
+    }
+
+    int trampleDamage = 0;
+    if (attacker.trample && attackerHits && attacker.attack > blocker.hp)
+    {
+        trampleDamage = attacker.attack - blocker.hp;
+    }
+
+    return CombatOutcome{attackerHp < 1, blockerHp < 1, attackerHp < 0 ? 0 : attackerHp, blockerHp < 0 ? 0 : blockerHp,
+                         trampleDamage};
+} // simulateCombat function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class CombatTable
+ * @brief Precomputed outcomes of every single creature matchup in the card pool.
+ *
+ * Stats in this card pool are small (attack 0-8, hp 1-8), so every attacker/blocker pairing is resolved at compile
+ * time into a 16 bit entry: bit 0 attacker dies, bit 1 blocker dies, bits 2-5 attacker hp left, bits 6-9 blocker hp
+ * left and bits 10-13 the damage that would trample over the blocker. The trample bit of the attacker is applied at
+ * lookup time and the blocker's trample never matters, which keeps the table at 144 x 144 entries.
+ *
+ * Stats outside the table range (for example after HolyWar boosts or HolyLight drains) fall back to simulateCombat.
+ */
+class CombatTable
+{
+public:
+    static constexpr int MaxAttack = 8;
+    static constexpr int MaxHp = 8;
+    static constexpr int SideCount = (MaxAttack + 1) * MaxHp * 2;
+
+    /**
+     * @brief Checks whether a creature can be looked up in the table.
+     */
+    static constexpr bool inRange(const CreatureStats &s)
+    {
+        return s.attack >= 0 && s.attack <= MaxAttack && s.hp >= 1 && s.hp <= MaxHp;
+    }
+
+    /**
+     * @brief Returns the outcome of an attacker being blocked, in one lookup when both creatures are in range.
+     *
+     * @param attacker Stats of the attacking creature.
+     * @param blocker Stats of the blocking creature.
+     * @return The outcome of the fight.
+     */
+    static CombatOutcome lookup(const CreatureStats &attacker, const CreatureStats &blocker)
+    {
+        if (!inRange(attacker) || !inRange(blocker))
+        {
+            return simulateCombat(attacker, blocker);
+        }
+
+        const unsigned entry = table[sideIndex(attacker) * SideCount + sideIndex(blocker)];
+
+        return CombatOutcome{(entry & 1u) != 0, (entry & 2u) != 0, static_cast<int>((entry >> 2) & 15u),
+                             static_cast<int>((entry >> 6) & 15u),
+                             attacker.trample ? static_cast<int>((entry >> 10) & 15u) : 0};
+    }
+
+private:
+    static constexpr int sideIndex(const CreatureStats &s)
+    {
+        return (s.attack * MaxHp + (s.hp - 1)) * 2 + (s.firstStrike ? 1 : 0);
+    }
+
+    static const std::array<std::uint16_t, SideCount * SideCount> table;
+}; // CombatTable class
+//----------------------------------------------------------------------------------------------------------------------
+// Build every entry of the combat table at compile time, in the same order as CombatTable::sideIndex
+constexpr std::array<std::uint16_t, CombatTable::SideCount * CombatTable::SideCount> buildCombatTable()
+{
+    constexpr int sides = CombatTable::SideCount;
+    constexpr int maxHp = CombatTable::MaxHp;
+    std::array<std::uint16_t, sides * sides> t{};
+
+    for (int a = 0; a < sides; a++)
+    {
+        // the attacker is simulated with trample on, the bit is masked off in lookup()
+        const CreatureStats attacker{a / 2 / maxHp, a / 2 % maxHp + 1, (a & 1) != 0, true};
+
+        for (int b = 0; b < sides; b++)
+        {
+            const CreatureStats blocker{b / 2 / maxHp, b / 2 % maxHp + 1, (b & 1) != 0, false};
+            const CombatOutcome r = simulateCombat(attacker, blocker);
+
+            t[a * sides + b] = static_cast<std::uint16_t>((r.attackerDies ? 1 : 0) | (r.blockerDies ? 2 : 0) |
+                                                          (r.attackerHpLeft << 2) | (r.blockerHpLeft << 6) |
+                                                          (r.trampleDamage << 10));
+        }
+    }
+    return t;
+} // buildCombatTable function
+
+constexpr std::array<std::uint16_t, CombatTable::SideCount * CombatTable::SideCount> CombatTable::table = buildCombatTable();
+//----------------------------------------------------------------------------------------------------------------------
+// Read the combat stats of a card that is in play
+CreatureStats creatureStatsOf(const Card &card)
+{
+    return CreatureStats{card.getAttackPower(), card.getHp(), card.getFirstStrike(), card.getTrample()};
+} // creatureStatsOf function
+//======================================================================================================================
+/**
+ * @class BlockSolver
+ * @brief Finds the block assignment that costs the defending player the least.
+ *
+ * The cost of an assignment is the damage taken by the defending player (weighted by DamageWeight, since hp is what
+ * loses the game) plus the value (attack + hp) of the blockers that die, minus the value of the attackers they kill.
+ * Every defender blocks at most one attacker.
+ *
+ * The search walks the attackers in order and tries the defenders for each one from cheapest to most expensive,
+ * cutting a branch as soon as its cost plus a lower bound for the remaining attackers can not beat the best branch
+ * found so far. Defenders are sorted by stats and identical defenders are only tried in that order, so the search
+ * runs over multisets of creatures and (attacker, used defenders) results are memoized.
+ */
+class BlockSolver
+{
+public:
+    static constexpr int NoBlock = -1;
+    static constexpr int MaxCreatures = 16;
+    static constexpr int DamageWeight = 2;
+
+    using CreatureList = StaticVector<CreatureStats, MaxCreatures>;
+    using Assignment = StaticVector<int, MaxCreatures>;
+
+    /**
+     * @brief Solves the blocks for the declared attackers.
+     *
+     * @param attackers Stats of the attacking creatures.
+     * @param defenders Stats of the untapped creatures that may block.
+     * @return For every attacker the index of its blocker in defenders, or NoBlock.
+     */
+    Assignment solve(const CreatureList &attackers, const CreatureList &defenders)
+    {
+        attackerCount = attackers.size();
+        defenderCount = defenders.size();
+
+        // sort defenders so identical creatures sit next to each other
+        for (int d = 0; d < defenderCount; d++)
+        {
+            order[d] = d;
+        }
+        std::sort(order, order + defenderCount, [&](int x, int y)
+                  { return packStats(defenders[x]) < packStats(defenders[y]); });
+        for (int d = 0; d < defenderCount; d++)
+        {
+            sortedKey[d] = packStats(defenders[order[d]]);
+        }
+
+        for (int a = 0; a < attackerCount; a++)
+        {
+            const CreatureStats &attacker = attackers[a];
+            noBlockCost[a] = DamageWeight * (attacker.attack > 0 ? attacker.attack : 0);
+
+            int cheapest = noBlockCost[a];
+            for (int d = 0; d < defenderCount; d++)
+            {
+                const CreatureStats &defender = defenders[order[d]];
+                const CombatOutcome r = CombatTable::lookup(attacker, defender);
+
+                blockCost[a][d] = DamageWeight * r.trampleDamage + (r.blockerDies ? value(defender) : 0) -
+                                  (r.attackerDies ? value(attacker) : 0);
+                optionOrder[a][d] = d;
+                if (blockCost[a][d] < cheapest)
+                {
+                    cheapest = blockCost[a][d];
+                }
+            }
+            std::sort(optionOrder[a], optionOrder[a] + defenderCount, [&](int x, int y)
+                      { return blockCost[a][x] < blockCost[a][y]; });
+            cheapestCost[a] = cheapest;
+        }
+
+        lowerBound[attackerCount] = 0;
+        for (int a = attackerCount - 1; a >= 0; a--)
+        {
+            lowerBound[a] = lowerBound[a + 1] + cheapestCost[a];
+        }
+
+        clearMemo();
+        bestCost = best(0, 0);
+
+        // walk the memoized optimum again to read the assignment back
+        Assignment assignment;
+        while (assignment.size() < attackerCount)
+        {
+            assignment.push_back(NoBlock);
+        }
+        std::uint32_t used = 0;
+        for (int a = 0; a < attackerCount; a++)
+        {
+            const int target = best(a, used);
+            if (noBlockCost[a] + best(a + 1, used) == target)
+            {
+                continue;
+            }
+            for (int d = 0; d < defenderCount; d++)
+            {
+                if (isTryable(d, used) && blockCost[a][d] + best(a + 1, used | (1u << d)) == target)
+                {
+                    assignment[a] = order[d];
+                    used |= 1u << d;
+                    break;
+                }
+            }
+        }
+        return assignment;
+    }
+
+    /**
+     * @brief Returns the cost of the assignment found by the last solve() call.
+     */
+    int getBestCost() { return bestCost; }
+
+private:
+    int attackerCount = 0;
+    int defenderCount = 0;
+    int bestCost = 0;
+    int order[MaxCreatures];
+    int sortedKey[MaxCreatures];
+    int noBlockCost[MaxCreatures];
+    int cheapestCost[MaxCreatures];
+    int lowerBound[MaxCreatures + 1];
+    int blockCost[MaxCreatures][MaxCreatures];
+    int optionOrder[MaxCreatures][MaxCreatures];
+
+    // Memo of best(), an open addressed table of (key, cost) pairs. Entries from earlier solves are told apart by
+    // their generation, so clearing is free and a solver that is reused stops allocating once its table is big enough.
+    struct MemoEntry
+    {
+        std::uint32_t key;
+        std::uint32_t generation;
+        int cost;
+    };
+    std::vector<MemoEntry> memo;
+    std::uint32_t generation = 0;
+    int memoBits = 0;
+    int memoCount = 0;
+
+    void clearMemo()
+    {
+        if (memo.empty())
+        {
+            memoBits = 10;
+            memo.assign(std::size_t(1) << memoBits, MemoEntry{0, 0, 0});
+        }
+        if (++generation == 0)
+        {
+            std::fill(memo.begin(), memo.end(), MemoEntry{0, 0, 0});
+            generation = 1;
+        }
+        memoCount = 0;
+    }
+
+    int memoSlot(std::uint32_t key) const { return static_cast<int>((key * 0x9E3779B1u) >> (32 - memoBits)); }
+
+    bool findMemo(std::uint32_t key, int &cost) const
+    {
+        const int mask = static_cast<int>(memo.size()) - 1;
+        for (int i = memoSlot(key); memo[i].generation == generation; i = (i + 1) & mask)
+        {
+            if (memo[i].key == key)
+            {
+                cost = memo[i].cost;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void storeMemo(std::uint32_t key, int cost)
+    {
+        if (memoCount >= static_cast<int>(memo.size()) / 4 * 3)
+        {
+            growMemo();
+        }
+        const int mask = static_cast<int>(memo.size()) - 1;
+        int i = memoSlot(key);
+        while (memo[i].generation == generation)
+        {
+            i = (i + 1) & mask;
+        }
+        memo[i] = MemoEntry{key, generation, cost};
+        memoCount++;
+    }
+
+    void growMemo()
+    {
+        std::vector<MemoEntry> old(std::size_t(1) << (memoBits + 1), MemoEntry{0, 0, 0});
+        old.swap(memo);
+        memoBits++;
+        memoCount = 0;
+        for (const MemoEntry &e : old)
+        {
+            if (e.generation == generation)
+            {
+                storeMemo(e.key, e.cost);
+            }
+        }
+    }
+
+    static int value(const CreatureStats &s) { return s.attack + s.hp; }
+
+    static int packStats(const CreatureStats &s)
+    {
+        return ((s.attack & 0xff) << 10) | ((s.hp & 0xff) << 2) | (s.firstStrike ? 2 : 0) | (s.trample ? 1 : 0);
+    }
+
+    // A defender may only be used if it is free and no identical defender before it is still free
+    bool isTryable(int d, std::uint32_t used)
+    {
+        if (used & (1u << d))
+        {
+            return false;
+        }
+        return d == 0 || sortedKey[d] != sortedKey[d - 1] || (used & (1u << (d - 1)));
+    }
+
+    int best(int a, std::uint32_t used)
+    {
+        if (a == attackerCount)
+        {
+            return 0;
+        }
+
+        const std::uint32_t key = (static_cast<std::uint32_t>(a) << MaxCreatures) | used;
+        int cached;
+        if (findMemo(key, cached))
+        {
+            return cached;
+        }
+
+        int bestHere = noBlockCost[a] + best(a + 1, used);
+
+        for (int k = 0; k < defenderCount; k++)
+        {
+            const int d = optionOrder[a][k];
+            if (blockCost[a][d] + lowerBound[a + 1] >= bestHere)
+            {
+                break; // options are sorted by cost, none of the rest can do better
+            }
+            if (!isTryable(d, used))
+            {
+                continue;
+            }
+
+            const int c = blockCost[a][d] + best(a + 1, used | (1u << d));
+            if (c < bestHere)
+            {
+                bestHere = c;
+            }
+        }
+
+        storeMemo(key, bestHere);
+        return bestHere;
+    }
+}; // BlockSolver class
+//----------------------------------------------------------------------------------------------------------------------
+// Number of untapped creatures in play, the ones that can attack or block
+int untappedCreatureCount(const std::vector<Card> &inPlay)
+{
+    int count = 0;
+    for (const Card &card : inPlay)
+    {
+        if (!card.hasTappedInfo() && card.isCreature())
+        {
+            count++;
+        }
+    }
+    return count;
+} // untappedCreatureCount function
+//----------------------------------------------------------------------------------------------------------------------
+// Print the block assignment the solver suggests for the declared attack squad; a board with more creatures than the
+// solver takes on a side gets no hint rather than one for part of the board
+void printBlockHint(std::vector<Card> &attackerInplay, const int *squad, int squadSize, std::vector<Card> &defenderInplay)
+{
+    BlockSolver::CreatureList attackers;
+    BlockSolver::CreatureList defenders;
+    StaticVector<int, BlockSolver::MaxCreatures> defenderIndex;
+
+    if (squadSize > BlockSolver::MaxCreatures || untappedCreatureCount(defenderInplay) > BlockSolver::MaxCreatures)
+    {
+        std::cout << "hint: board too large for the block solver, more than " << BlockSolver::MaxCreatures << " creatures on a side" << std::endl;
+        return;
+    }
+
+    for (int i = 0; i < squadSize; i++)
+    {
+        attackers.push_back(creatureStatsOf(attackerInplay[squad[i]]));
+    }
+    for (int i = 0; i < static_cast<int>(defenderInplay.size()); i++)
+    {
+        if (!defenderInplay[i].hasTappedInfo() && defenderInplay[i].getCardtype() == "CreatureCard")
+        {
+            defenders.push_back(creatureStatsOf(defenderInplay[i]));
+            defenderIndex.push_back(i);
+        }
+    }
+
+    static BlockSolver solver; // kept between turns so its memo table is only allocated once
+    const BlockSolver::Assignment blocks = solver.solve(attackers, defenders);
+
+    std::cout << "hint: ";
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        std::cout << attackerInplay[squad[i]].getCardName() << " -> ";
+        if (blocks[i] == BlockSolver::NoBlock)
+        {
+            std::cout << "9 (no block)  ";
+        }
+        else
+        {
+            std::cout << defenderIndex[blocks[i]] << ")" << defenderInplay[defenderIndex[blocks[i]]].getCardName() << "  ";
+        }
+    }
+    std::cout << std::endl;
+} // printBlockHint function
+//======================================================================================================================
+/**
+ * @class LethalSolver
+ * @brief Answers whether the attacking player can bring the opponent to 0 hp this turn.
+ *
+ * Attacking with more creatures never lets the defender take less damage (the defender can always ignore the extra
+ * attacker), so only the all-out attack has to be checked against the defender's damage-minimizing blocks. A block
+ * prevents the attacker's power minus whatever tramples over the blocker.
+ *
+ * The solver first tries two bounds that settle most boards without a search: total attack plus burn below the hp
+ * means no lethal, and total attack minus the best prevention the defenders could possibly get still reaching the hp
+ * means lethal. Otherwise the defender's blocks are searched depth first, most dangerous attacker and best blocker
+ * first, and the search stops as soon as one block assignment keeps the defender alive.
+ */
+class LethalSolver
+{
+public:
+    /**
+     * @brief Checks whether an all-out attack plus burn damage is lethal against the best blocks.
+     *
+     * @param attackers Stats of the untapped creatures of the attacking player.
+     * @param defenders Stats of the untapped creatures of the defending player.
+     * @param opponentHp Current hp of the defending player.
+     * @param burnDamage Damage that can be dealt straight to the player, e.g. 2 per castable LightningBolt.
+     * @return True if the defending player can not survive.
+     */
+    bool hasLethal(const BlockSolver::CreatureList &attackers, const BlockSolver::CreatureList &defenders, int opponentHp, int burnDamage)
+    {
+        nodes = 0;
+        needed = opponentHp - burnDamage;
+        if (needed <= 0)
+        {
+            return true;
+        }
+
+        attackerCount = attackers.size();
+        defenderCount = defenders.size();
+
+        int total = 0;
+        for (int a = 0; a < attackerCount; a++)
+        {
+            power[a] = attackers[a].attack > 0 ? attackers[a].attack : 0;
+            total += power[a];
+        }
+        if (total < needed)
+        {
+            return false;
+        }
+
+        // prevention of every block, and the best prevention each attacker could get from any defender
+        for (int a = 0; a < attackerCount; a++)
+        {
+            maxPrevention[a] = 0;
+            for (int d = 0; d < defenderCount; d++)
+            {
+                prevention[a][d] = power[a] - CombatTable::lookup(attackers[a], defenders[d]).trampleDamage;
+                if (prevention[a][d] > maxPrevention[a])
+                {
+                    maxPrevention[a] = prevention[a][d];
+                }
+            }
+        }
+
+        // most dangerous attackers first, their blockers from the best to the worst
+        for (int a = 0; a < attackerCount; a++)
+        {
+            order[a] = a;
+        }
+        std::sort(order, order + attackerCount, [&](int x, int y)
+                  { return maxPrevention[x] > maxPrevention[y]; });
+
+        // each defender blocks once, so no more than the sum of the largest defenderCount preventions is possible
+        int bestPossible = 0;
+        for (int k = 0; k < attackerCount && k < defenderCount; k++)
+        {
+            bestPossible += maxPrevention[order[k]];
+        }
+        if (total - bestPossible >= needed)
+        {
+            return true;
+        }
+
+        for (int k = 0; k < attackerCount; k++)
+        {
+            const int a = order[k];
+            for (int d = 0; d < defenderCount; d++)
+            {
+                blockerOrder[k][d] = d;
+            }
+            std::sort(blockerOrder[k], blockerOrder[k] + defenderCount, [&](int x, int y)
+                      { return prevention[a][x] > prevention[a][y]; });
+        }
+
+        remainingPrevention[attackerCount] = 0;
+        for (int k = attackerCount - 1; k >= 0; k--)
+        {
+            remainingPrevention[k] = remainingPrevention[k + 1] + maxPrevention[order[k]];
+        }
+
+        return !defenderSurvives(0, 0, total);
+    }
+
+    /**
+     * @brief Returns how many search nodes the last hasLethal() call needed (0 when a bound settled it).
+     */
+    int getNodes() { return nodes; }
+
+private:
+    int needed = 0;
+    int attackerCount = 0;
+    int defenderCount = 0;
+    int nodes = 0;
+    int power[BlockSolver::MaxCreatures];
+    int order[BlockSolver::MaxCreatures];
+    int maxPrevention[BlockSolver::MaxCreatures];
+    int remainingPrevention[BlockSolver::MaxCreatures + 1];
+    int prevention[BlockSolver::MaxCreatures][BlockSolver::MaxCreatures];
+    int blockerOrder[BlockSolver::MaxCreatures][BlockSolver::MaxCreatures];
+
+    bool defenderSurvives(int k, std::uint32_t used, int damage)
+    {
+        nodes++;
+        if (damage < needed)
+        {
+            return true;
+        }
+        if (k == attackerCount || damage - remainingPrevention[k] >= needed)
+        {
+            return false;
+        }
+
+        const int a = order[k];
+        for (int i = 0; i < defenderCount; i++)
+        {
+            const int d = blockerOrder[k][i];
+            if (prevention[a][d] <= 0)
+            {
+                break;
+            }
+            if (!(used & (1u << d)) && defenderSurvives(k + 1, used | (1u << d), damage - prevention[a][d]))
+            {
+                return true;
+            }
+        }
+        return defenderSurvives(k + 1, used, damage);
+    }
+}; // LethalSolver class
+//----------------------------------------------------------------------------------------------------------------------
+// Damage a card of the active pool deals to the opponent when it is cast at them, 0 for every card but LightningBolt;
+// defined with the other lookups of the active pool
+inline int burnDamage(std::string_view name);
+
+// Damage the cards in hand can deal straight to the opponent with the current mana, each paid from what the ones before
+// it left in the pool
+int burnInHand(Hand &hand, std::unique_ptr<Mana> &mana)
+{
+    int burn = 0;
+    Mana pool(*mana);
+
+    for (auto it = hand.begin(); it != hand.end(); it++)
+    {
+        const int damage = burnDamage(it->getCardName());
+        if (damage > 0 && pool.spend(it->getCardName()))
+        {
+            burn += damage;
+        }
+    }
+    return burn;
+} // burnInHand function
+//----------------------------------------------------------------------------------------------------------------------
+// Check whether the attacking side can kill the opponent this turn with its untapped creatures and burn in hand. A
+// board with more creatures than the solver takes on a side is reported and not checked, rather than checked in part
+bool hasLethalOnBoard(std::vector<Card> &attackerInplay, Hand &attackerHand, std::unique_ptr<Mana> &mana, std::vector<Card> &defenderInplay, std::unique_ptr<Player> &playerOp)
+{
+    BlockSolver::CreatureList attackers;
+    BlockSolver::CreatureList defenders;
+
+    if (untappedCreatureCount(attackerInplay) > BlockSolver::MaxCreatures || untappedCreatureCount(defenderInplay) > BlockSolver::MaxCreatures)
+    {
+        std::cout << "lethal check: board too large for the solver, more than " << BlockSolver::MaxCreatures << " creatures on a side" << std::endl;
+        return false;
+    }
+
+    for (std::size_t i = 0; i < attackerInplay.size(); i++)
+    {
+        if (!attackerInplay[i].hasTappedInfo() && attackerInplay[i].getCardtype() == "CreatureCard")
+        {
+            attackers.push_back(creatureStatsOf(attackerInplay[i]));
+        }
+    }
+    for (std::size_t i = 0; i < defenderInplay.size(); i++)
+    {
+        if (!defenderInplay[i].hasTappedInfo() && defenderInplay[i].getCardtype() == "CreatureCard")
+        {
+            defenders.push_back(creatureStatsOf(defenderInplay[i]));
+        }
+    }
+
+    LethalSolver solver;
+    return solver.hasLethal(attackers, defenders, playerOp->getHp(), burnInHand(attackerHand, mana));
+} // hasLethalOnBoard function
+//======================================================================================================================
+/**
+ * @brief Card colors, in the same order as the mana pools of the Mana class. Lands carry the color they produce.
+ */
+enum class CardColor : std::uint8_t
+{
+    White,
+    Red,
+    Green,
+    Blue,
+    Black,
+    None
+};
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief What a sorcery or enhancement card does when it is played.
+ *
+ * The kind says what an effect does, the effectAttack and effectHp of the card say how much: the change to the attack
+ * and hp of every creature it hits. LightningBolt and Plague deal -effectHp damage, to a player too. HolyWar,
+ * HolyLight and UnholyWar change the stats of the creatures of their color. The other effects have no amounts.
+ */
+enum class EffectKind : std::uint8_t
+{
+    None,
+    Disenchant,
+    LightningBolt,
+    Flood,
+    Reanimate,
+    Plague,
+    Terror,
+    Rage,
+    HolyWar,
+    HolyLight,
+    UnholyWar,
+    Restrain,
+    Slow
+};
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct CardPrototype
+ * @brief The printed definition of a card: everything that is the same for every copy of it.
+ *
+ * cost holds the colored mana requirements in CardColor order, generic is the extra mana of any color. effectAttack
+ * and effectHp are the amounts of the effect (see EffectKind). Every field is a byte or a byte array, so the layout
+ * has no padding and no pointers and a table of prototypes can be used straight from a mapped file (see CardImage).
+ */
+struct CardPrototype
+{
+    static constexpr int MaxNameLength = 23;
+
+    char name[MaxNameLength + 1];
+    CardKind kind;
+    CardColor color;
+    std::uint8_t cost[5];
+    std::uint8_t generic;
+    std::int8_t attack;
+    std::int8_t hp;
+    bool firstStrike;
+    bool trample;
+    EffectKind effect;
+    std::int8_t effectAttack;
+    std::int8_t effectHp;
+}; // CardPrototype struct
+//----------------------------------------------------------------------------------------------------------------------
+inline Card Card::fromPrototype(const CardPrototype &proto)
+{
+    static const char *const TypeNames[] = {"LandCard", "CreatureCard", "SorceryCard", "EnhancementCard"}; // CardKind order
+    static const char *const ColorNames[] = {"White", "Red", "Green", "Blue", "Black", " "};               // CardColor order
+    static const char *const EffectTexts[] = {" ",                                                        // EffectKind order
+                                              "Destroy 1 Target Enchantment",
+                                              "Deal dmg to target creature or player",
+                                              "Destroy 1 Target Land",
+                                              "Return 1 character card from discard to hand",
+                                              "Deal dmg to all creatures",
+                                              "Destroy 1 Target Creature",
+                                              "1 Target creature gains Trample",
+                                              "All white creatures gain stats",
+                                              "All black creatures lose stats",
+                                              "All black creatures gain stats",
+                                              "All green creatures lose Trample",
+                                              "1 Target creature loses First Strike"};
+
+    // lands have no color text in the interactive game; they are told apart by name
+    const int color = proto.kind == CardKind::Land ? 5 : static_cast<int>(proto.color);
+    Card card(proto.kind, proto.name, TypeNames[static_cast<int>(proto.kind)], ColorNames[color]);
+    if (proto.kind != CardKind::Land)
+    {
+        card.manaCost = " "; // Mana reads the cost from the prototype
+        card.effect = EffectTexts[static_cast<int>(proto.effect)];
+    }
+    if (proto.kind == CardKind::Creature)
+    {
+        card.attackPower = proto.attack;
+        card.baseHP = card.hp = proto.hp;
+        card.baseFirstStrike = card.firstStrike = proto.firstStrike;
+        card.baseTrample = card.trample = proto.trample;
+    }
+    return card;
+} // fromPrototype function
+//----------------------------------------------------------------------------------------------------------------------
+using CardId = std::uint16_t;
+
+// The card pool that main() builds by hand, as one table of prototypes
+constexpr CardPrototype BuiltinCards[] = {
+    // land cards
+    {"Forest", CardKind::Land, CardColor::Green, {0, 0, 0, 0, 0}, 0, 0, 0, false, false, EffectKind::None, 0, 0},
+    {"Island", CardKind::Land, CardColor::Blue, {0, 0, 0, 0, 0}, 0, 0, 0, false, false, EffectKind::None, 0, 0},
+    {"Mountain", CardKind::Land, CardColor::Red, {0, 0, 0, 0, 0}, 0, 0, 0, false, false, EffectKind::None, 0, 0},
+    {"Plains", CardKind::Land, CardColor::White, {0, 0, 0, 0, 0}, 0, 0, 0, false, false, EffectKind::None, 0, 0},
+    {"Swamp", CardKind::Land, CardColor::Black, {0, 0, 0, 0, 0}, 0, 0, 0, false, false, EffectKind::None, 0, 0},
+
+    // creature cards
+    {"Soldier", CardKind::Creature, CardColor::White, {1, 0, 0, 0, 0}, 0, 1, 1, false, false, EffectKind::None, 0, 0},
+    {"ArmoredPegasus", CardKind::Creature, CardColor::White, {1, 0, 0, 0, 0}, 1, 1, 2, false, false, EffectKind::None, 0, 0},
+    {"WhiteKnight", CardKind::Creature, CardColor::White, {2, 0, 0, 0, 0}, 0, 2, 2, true, false, EffectKind::None, 0, 0},
+    {"AngryBear", CardKind::Creature, CardColor::Green, {0, 0, 1, 0, 0}, 2, 3, 2, false, true, EffectKind::None, 0, 0},
+    {"Guard", CardKind::Creature, CardColor::White, {2, 0, 0, 0, 0}, 2, 2, 5, false, false, EffectKind::None, 0, 0},
+    {"Werewolf", CardKind::Creature, CardColor::Green, {1, 0, 1, 0, 0}, 2, 4, 6, false, true, EffectKind::None, 0, 0},
+    {"Skeleton", CardKind::Creature, CardColor::Black, {0, 0, 0, 0, 1}, 0, 1, 1, false, false, EffectKind::None, 0, 0},
+    {"Ghost", CardKind::Creature, CardColor::Black, {0, 0, 0, 0, 1}, 1, 2, 1, false, false, EffectKind::None, 0, 0},
+    {"BlackKnight", CardKind::Creature, CardColor::Black, {0, 0, 0, 0, 2}, 0, 2, 2, true, false, EffectKind::None, 0, 0},
+    {"OrcManiac", CardKind::Creature, CardColor::Red, {0, 1, 0, 0, 0}, 2, 4, 1, false, false, EffectKind::None, 0, 0},
+    {"Hobgoblin", CardKind::Creature, CardColor::Red, {0, 1, 0, 0, 1}, 1, 3, 3, false, false, EffectKind::None, 0, 0},
+    {"Vampire", CardKind::Creature, CardColor::Black, {0, 0, 0, 0, 1}, 3, 6, 3, false, false, EffectKind::None, 0, 0},
+
+    // sorcery cards
+    {"Disenchant", CardKind::Sorcery, CardColor::White, {1, 0, 0, 0, 0}, 1, 0, 0, false, false, EffectKind::Disenchant, 0, 0},
+    {"LightningBolt", CardKind::Sorcery, CardColor::Green, {0, 0, 1, 0, 0}, 1, 0, 0, false, false, EffectKind::LightningBolt, 0, -2},
+    {"Flood", CardKind::Sorcery, CardColor::Green, {1, 0, 1, 0, 0}, 1, 0, 0, false, false, EffectKind::Flood, 0, 0},
+    {"Reanimate", CardKind::Sorcery, CardColor::Black, {0, 0, 0, 0, 1}, 0, 0, 0, false, false, EffectKind::Reanimate, 0, 0},
+    {"Plague", CardKind::Sorcery, CardColor::Black, {0, 0, 0, 0, 1}, 2, 0, 0, false, false, EffectKind::Plague, 0, -1},
+    {"Terror", CardKind::Sorcery, CardColor::Black, {0, 0, 0, 0, 1}, 1, 0, 0, false, false, EffectKind::Terror, 0, 0},
+
+    // enchantment cards
+    {"Rage", CardKind::Enhancement, CardColor::Green, {0, 0, 1, 0, 0}, 0, 0, 0, false, false, EffectKind::Rage, 0, 0},
+    {"HolyWar", CardKind::Enhancement, CardColor::White, {1, 0, 0, 0, 0}, 1, 0, 0, false, false, EffectKind::HolyWar, 1, 1},
+    {"HolyLight", CardKind::Enhancement, CardColor::White, {1, 0, 0, 0, 0}, 1, 0, 0, false, false, EffectKind::HolyLight, -1, -1},
+    {"UnholyWar", CardKind::Enhancement, CardColor::Black, {0, 0, 0, 0, 1}, 1, 0, 0, false, false, EffectKind::UnholyWar, 2, 0},
+    {"Restrain", CardKind::Enhancement, CardColor::Red, {0, 1, 0, 0, 0}, 2, 0, 0, false, false, EffectKind::Restrain, 0, 0},
+    {"Slow", CardKind::Enhancement, CardColor::Black, {0, 0, 0, 0, 1}, 0, 0, 0, false, false, EffectKind::Slow, 0, 0},
+};
+
+constexpr int BuiltinCardCount = sizeof(BuiltinCards) / sizeof(BuiltinCards[0]);
+
+// The two libraries main() builds, as prototype ids into BuiltinCards
+constexpr CardId BuiltinDeck1[] = {3, 3, 3, 3, 3, 0, 0, 0, 1, 5, 5, 5, 6, 6, 7, 7, 8, 9, 10, 17, 18, 19, 19, 23, 24, 25};
+constexpr CardId BuiltinDeck2[] = {4, 4, 4, 4, 4, 2, 2, 2, 1, 11, 11, 11, 12, 12, 13, 13, 14, 15, 16, 20, 21, 22, 22, 26, 27, 28};
+constexpr int BuiltinDeckSize = sizeof(BuiltinDeck1) / sizeof(BuiltinDeck1[0]);
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class CardNameIndex
+ * @brief A minimal perfect hash from card names to card ids.
+ *
+ * The names are hashed into one bucket per card and every bucket, fullest first, gets the smallest seed that sends
+ * all of its names to free slots (hash and displace). find() hashes the name once, mixes in the seed of its bucket and
+ * compares the single candidate it lands on, so a lookup never probes and never allocates. The index holds no pointers
+ * and can be built in a constant expression, as it is for the built-in pool (BuiltinNameIndex).
+ *
+ * Card ids are 16 bits everywhere the engine stores them; MaxCards bounds the fixed-size tables of the index, which
+ * take 16 KB per pool.
+ */
+class CardNameIndex
+{
+public:
+    static constexpr int MaxCards = 4096;
+
+    constexpr CardNameIndex() = default;
+
+    /**
+     * @brief Builds the index of a pool whose names are all different.
+     *
+     * ready() is false if the pool is too large or no seed separates two of the names.
+     */
+    constexpr CardNameIndex(const CardPrototype *cards, int count)
+    {
+        if (count < 0 || count > MaxCards)
+        {
+            return;
+        }
+
+        std::uint64_t hashes[MaxCards] = {};
+        int bucketStart[MaxCards + 1] = {};
+        int members[MaxCards] = {};
+        int maxBucket = 0;
+
+        // group the cards by bucket with a counting sort
+        for (int i = 0; i < count; i++)
+        {
+            hashes[i] = hashName(cards[i].name);
+            bucketStart[reduce(hashes[i], count) + 1]++;
+        }
+        for (int b = 0; b < count; b++)
+        {
+            maxBucket = bucketStart[b + 1] > maxBucket ? bucketStart[b + 1] : maxBucket;
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        int fill[MaxCards] = {};
+        for (int i = 0; i < count; i++)
+        {
+            const int b = reduce(hashes[i], count);
+            members[bucketStart[b] + fill[b]++] = i;
+        }
+
+        bool taken[MaxCards] = {};
+        for (int want = maxBucket; want > 0; want--)
+        {
+            for (int b = 0; b < count; b++)
+            {
+                if (bucketStart[b + 1] - bucketStart[b] != want)
+                {
+                    continue;
+                }
+
+                int seed = 0;
+                while (!fits(hashes, members + bucketStart[b], want, seed, count, taken))
+                {
+                    if (++seed > MaxSeed)
+                    {
+                        return;
+                    }
+                }
+                seeds[b] = static_cast<std::uint16_t>(seed);
+                for (int m = 0; m < want; m++)
+                {
+                    const int card = members[bucketStart[b] + m];
+                    const int slot = reduce(mix(hashes[card], seed), count);
+                    taken[slot] = true;
+                    slots[slot] = static_cast<CardId>(card);
+                }
+            }
+        }
+        size = count;
+        built = true;
+    }
+
+    constexpr bool ready() const { return built; }
+
+    /**
+     * @brief Returns the id of the card with the given name in the pool the index was built from, or -1.
+     */
+    constexpr int find(std::string_view name, const CardPrototype *cards) const
+    {
+        if (size == 0)
+        {
+            return -1;
+        }
+        const std::uint64_t h = hashName(name);
+        const int id = slots[reduce(mix(h, seeds[reduce(h, size)]), size)];
+        const std::size_t length = name.size();
+        return length <= CardPrototype::MaxNameLength && cards[id].name[length] == '\0' &&
+                       std::char_traits<char>::compare(name.data(), cards[id].name, length) == 0
+                   ? id
+                   : -1;
+    }
+
+private:
+    static constexpr int MaxSeed = 0xFFFF;
+
+    std::uint16_t seeds[MaxCards] = {};
+    CardId slots[MaxCards] = {};
+    int size = 0;
+    bool built = false;
+
+    // Hash a name eight bytes at a time; the last word overlaps the one before it rather than being padded
+    static constexpr std::uint64_t hashName(std::string_view name)
+    {
+        const char *p = name.data();
+        const std::size_t n = name.size();
+        std::uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+
+        if (n >= 8)
+        {
+            for (std::size_t i = 0; i + 8 < n; i += 8)
+            {
+                h = mixWord(h, loadWord(p + i));
+            }
+            return mixWord(h, loadWord(p + n - 8));
+        }
+
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            word |= byteAt(p, static_cast<int>(i));
+        }
+        return mixWord(h, word);
+    }
+
+    static constexpr std::uint64_t byteAt(const char *p, int k) { return static_cast<std::uint64_t>(static_cast<std::uint8_t>(p[k])) << (8 * k); }
+
+    // Written out so that the compiler turns it into a single load
+    static constexpr std::uint64_t loadWord(const char *p)
+    {
+        return byteAt(p, 0) | byteAt(p, 1) | byteAt(p, 2) | byteAt(p, 3) | byteAt(p, 4) | byteAt(p, 5) | byteAt(p, 6) | byteAt(p, 7);
+    }
+
+    static constexpr std::uint64_t mixWord(std::uint64_t h, std::uint64_t word)
+    {
+        h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+        return h ^ (h >> 29);
+    }
+
+    // Map a hash onto 0..count-1 with a multiply instead of a division
+    static constexpr int reduce(std::uint64_t h, int count) { return static_cast<int>(((h >> 32) * static_cast<std::uint64_t>(count)) >> 32); }
+
+    // Derive the slot hash of a name for one seed without hashing the name again
+    static constexpr std::uint64_t mix(std::uint64_t h, int seed)
+    {
+        std::uint64_t x = h ^ (static_cast<std::uint64_t>(seed) * 0x9E3779B97F4A7C15ull);
+        x ^= x >> 32;
+        x *= 0xD6E8FEB86659FD93ull;
+        return x ^ (x >> 32);
+    }
+
+    // Whether a seed sends every name of a bucket to a different free slot; buckets hold a handful of names
+    static constexpr bool fits(const std::uint64_t *hashes, const int *bucket, int bucketSize, int seed, int count, const bool *taken)
+    {
+        for (int m = 0; m < bucketSize; m++)
+        {
+            const int slot = reduce(mix(hashes[bucket[m]], seed), count);
+            if (taken[slot])
+            {
+                return false;
+            }
+            for (int k = 0; k < m; k++)
+            {
+                if (reduce(mix(hashes[bucket[k]], seed), count) == slot)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}; // CardNameIndex class
+//----------------------------------------------------------------------------------------------------------------------
+// The name index of the built-in pool, built by the compiler
+constexpr CardNameIndex BuiltinNameIndex(BuiltinCards, BuiltinCardCount);
+static_assert(BuiltinNameIndex.ready(), "the built-in card names must be different");
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct CardTable
+ * @brief A card pool and its two deck lists as the engine reads them.
+ *
+ * The tables are not owned; they point at the built-in constants or at the storage of a CardDatabase or CardImage.
+ * names is the perfect hash of the card names (see findCard()).
+ */
+struct CardTable
+{
+    const CardPrototype *cards;
+    int cardCount;
+    const CardId *decks[2];
+    int deckSizes[2];
+    const CardNameIndex *names;
+}; // CardTable struct
+
+const CardTable BuiltinCardTable = {BuiltinCards, BuiltinCardCount, {BuiltinDeck1, BuiltinDeck2}, {BuiltinDeckSize, BuiltinDeckSize}, &BuiltinNameIndex};
+
+// Hash of a card pool's prototypes and dealt decks; a replay log stores it to tell which pool it was recorded with
+inline std::uint64_t cardTableHash(const CardTable &table)
+{
+    std::uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void *data, std::size_t size)
+    {
+        const std::uint8_t *bytes = static_cast<const std::uint8_t *>(data);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            h = (h ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    mix(table.cards, static_cast<std::size_t>(table.cardCount) * sizeof(CardPrototype)); // prototypes have no padding
+    for (int d = 0; d < 2; d++)
+    {
+        mix(&table.deckSizes[d], sizeof(int));
+        mix(table.decks[d], static_cast<std::size_t>(table.deckSizes[d]) * sizeof(CardId));
+    }
+    return h;
+}
+
+// The card pool a game is dealt from when no table is given to GameState::reset(); see useCardTable(). It is atomic
+// because worker threads read it while the control thread may switch pools
+inline std::atomic<const CardTable *> activeCardTable{&BuiltinCardTable};
+
+// Make a card pool the one new games are dealt from; it must outlive every game that uses it. Servers that replace
+// the pool while games run use a CardTableRegistry instead
+inline void useCardTable(const CardTable &table) { activeCardTable.store(&table, std::memory_order_release); }
+
+// The active card pool; load it once per lookup, so an id and the prototype it indexes come from the same pool
+inline const CardTable &getActiveCardTable() { return *activeCardTable.load(std::memory_order_acquire); }
+
+// Look up a card of the active pool by name, or -1
+inline int findCard(std::string_view name, const CardTable &table = getActiveCardTable()) { return table.names->find(name, table.cards); }
+
+// The printed definition of a card of the active pool, or nullptr
+inline const CardPrototype *cardPrototype(std::string_view name)
+{
+    const CardTable &table = getActiveCardTable();
+    const int id = findCard(name, table);
+    return id < 0 ? nullptr : &table.cards[id];
+}
+
+// The effect a sorcery or enhancement card of the active pool has when it is played
+inline EffectKind cardEffect(std::string_view name)
+{
+    const CardPrototype *proto = cardPrototype(name);
+    return proto == nullptr ? EffectKind::None : proto->effect;
+}
+
+inline int burnDamage(std::string_view name)
+{
+    const CardPrototype *proto = cardPrototype(name);
+    return proto == nullptr || proto->effect != EffectKind::LightningBolt ? 0 : -proto->effectHp;
+}
+//----------------------------------------------------------------------------------------------------------------------
+// The Mana lookups by card name read the active pool, so they are defined once it exists
+
+inline bool Mana::isManaEnough(std::string_view cardName)
+{
+    const CardTable &table = getActiveCardTable();
+    const int id = findCard(cardName, table);
+    if (id < 0)
+    {
+        return false; // Card not found in the pool
+    }
+
+    const CardPrototype &card = table.cards[id];
+    const int pools[5] = {whiteMana, redMana, greenMana, blueMana, blackMana}; // CardColor order
+    for (int c = 0; c < 5; c++)
+    {
+        if (card.cost[c] > pools[c])
+        {
+            return false;
+        }
+    }
+
+    // lands ask for one mana of any color to be played
+    const int generic = card.kind == CardKind::Land ? 1 : card.generic;
+    return generic <= whiteMana + redMana + greenMana + blueMana + blackMana;
+}
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mana::cost(std::string_view cardName)
+{
+    static const char *const ManaTypes[] = {"white", "red", "green", "blue", "black"}; // CardColor order
+
+    const CardTable &table = getActiveCardTable();
+    const int id = findCard(cardName, table);
+    if (id < 0)
+    {
+        std::cout << "Card " << cardName << " not found." << std::endl;
+        return;
+    }
+    if (!isManaEnough(cardName))
+    {
+        std::cout << "Not enough mana for " << cardName << ". " << std::endl;
+        return;
+    }
+
+    // Deduct the colored cost; the generic part is paid in the colors the player picks in getMana()
+    for (int c = 0; c < 5; c++)
+    {
+        for (int i = 0; i < table.cards[id].cost[c]; i++)
+        {
+            deductMana(ManaTypes[c]);
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+inline bool Mana::spend(std::string_view cardName)
+{
+    const CardTable &table = getActiveCardTable();
+    const int id = findCard(cardName, table);
+    if (id < 0)
+    {
+        return false;
+    }
+
+    const CardPrototype &card = table.cards[id];
+    const int generic = card.kind == CardKind::Land ? 1 : card.generic;
+    int *pools[5] = {&whiteMana, &redMana, &greenMana, &blueMana, &blackMana}; // CardColor order
+    int left = 0;
+    for (int c = 0; c < 5; c++)
+    {
+        if (card.cost[c] > *pools[c])
+        {
+            return false;
+        }
+        left += *pools[c] - card.cost[c];
+    }
+    if (generic > left)
+    {
+        return false;
+    }
+
+    for (int c = 0; c < 5; c++)
+    {
+        *pools[c] -= card.cost[c];
+    }
+    for (int g = 0; g < generic; g++)
+    {
+        int largest = 0;
+        for (int c = 1; c < 5; c++)
+        {
+            if (*pools[c] > *pools[largest])
+            {
+                largest = c;
+            }
+        }
+        (*pools[largest])--;
+    }
+    return true;
+}
+//----------------------------------------------------------------------------------------------------------------------
+inline void Mana::increaseManaWithTap(std::string_view c)
+{
+    cardName = c;
+
+    const CardTable &table = getActiveCardTable();
+    const int id = findCard(c, table);
+    if (id < 0 || table.cards[id].kind != CardKind::Land)
+    {
+        return;
+    }
+
+    switch (table.cards[id].color)
+    {
+    case CardColor::White:
+        whiteMana++;
+        break;
+    case CardColor::Red:
+        redMana++;
+        break;
+    case CardColor::Green:
+        greenMana++;
+        break;
+    case CardColor::Blue:
+        blueMana++;
+        break;
+    case CardColor::Black:
+        blackMana++;
+        break;
+    default:
+        break;
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+// The effects of the interactive game read their amounts from the active pool too
+
+inline void DestroyCardEffect::reverseEnhancement(std::vector<Card> &ip, std::string_view enhancement)
+{
+    const CardPrototype *proto = cardPrototype(enhancement);
+    if (proto == nullptr)
+    {
+        return;
+    }
+
+    for (Card &card : ip)
+    {
+        switch (proto->effect)
+        {
+        case EffectKind::Rage:
+            card.trampleBase();
+            break;
+        case EffectKind::HolyWar:
+            if (card.getCardColor() == "White")
+            {
+                card.changeStats(-proto->effectAttack, -proto->effectHp);
+            }
+            break;
+        case EffectKind::HolyLight:
+            if (card.getCardColor() == "Black")
+            {
+                card.changeStats(-proto->effectAttack, -proto->effectHp);
+            }
+            break;
+        case EffectKind::UnholyWar:
+            if (card.getCardColor() == "Black")
+            {
+                card.reverseAttackBoost(proto->effectAttack);
+                card.changeStats(0, -proto->effectHp);
+            }
+            break;
+        case EffectKind::Restrain:
+            if (card.getCardColor() == "Green")
+            {
+                card.trampleBase();
+            }
+            break;
+        case EffectKind::Slow:
+            card.firstStrikeBase();
+            break;
+        default:
+            break;
+        }
+    }
+}
+//----------------------------------------------------------------------------------------------------------------------
+inline void EffectForColorEffect::effectThatColorMembers(std::vector<Card> &ip, std::string_view s)
+{
+    const CardPrototype *proto = cardPrototype(s);
+    if (proto == nullptr)
+    {
+        return;
+    }
+
+    std::string_view color;
+    switch (proto->effect)
+    {
+    case EffectKind::HolyWar:
+        color = "White";
+        break;
+    case EffectKind::HolyLight:
+    case EffectKind::UnholyWar:
+        color = "Black";
+        break;
+    default:
+        return;
+    }
+
+    for (Card &card : ip)
+    {
+        if (card.getCardColor() == color)
+        {
+            card.changeStats(proto->effectAttack, proto->effectHp);
+        }
+    }
+    std::cout << "all " << (color == "White" ? "white" : "black") << " creature cards in your side that in play gain " << std::showpos
+              << static_cast<int>(proto->effectAttack) << "/" << static_cast<int>(proto->effectHp) << std::noshowpos << " " << std::endl;
+}
+//----------------------------------------------------------------------------------------------------------------------
+inline void DealDamageEffect::dealDamage(std::vector<Card> &ip, std::string_view n, std::unique_ptr<Player> &player)
+{
+    const CardPrototype *proto = cardPrototype(n);
+    if (proto == nullptr)
+    {
+        return;
+    }
+    const int damage = -proto->effectHp;
+
+    if (proto->effect == EffectKind::Plague)
+    {
+        for (Card &card : ip)
+        {
+            card.sustainDamage(damage);
+        }
+        std::cout << "all opponent's creature cards dealt " << damage << " damage " << std::endl;
+    }
+
+    else if (proto->effect == EffectKind::LightningBolt)
+    {
+
+        std::cout << "please choose given options below and type its number" << std::endl;
+        std::cout << "1)Deal damage to player" << std::endl;
+        std::cout << "2)Deal damage to target creature card" << std::endl;
+
+        int a;
+
+        std::cin >> a;
+
+        if (a == 1)
+        {
+            player->susDamage(damage);
+            std::cout << "dealt " << damage << " damage to the opponent player" << std::endl;
+        }
+
+        else if (a == 2)
+        {
+            for (Card &card : ip)
+            {
+                if (card.getCardtype() == "CreatureCard")
+                {
+                    card.sustainDamage(damage);
+                    std::cout << "dealt " << card.getCardName() << " " << damage << " damage " << std::endl;
+                }
+            }
+        }
+
+        else
+        {
+            std::cout << "YOU HAVE MISSED YOUR CHANCE " << std::endl;
+        }
+    }
+}
+//======================================================================================================================
+/**
+ * @struct CreatureSlot
+ * @brief A creature card on the battlefield of the headless engine.
+ */
+struct CreatureSlot
+{
+    CardId card;
+    std::int8_t attack;
+    std::int8_t hp;        // hp left this turn
+    std::int8_t toughness; // hp the creature heals back to at the end of the turn
+    bool firstStrike;
+    bool trample;
+    bool tapped;
+}; // CreatureSlot struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct PlayerState
+ * @brief Every zone and counter of one player, stored inline so a whole game can be copied with memcpy.
+ */
+struct PlayerState
+{
+    static constexpr int MaxLibrary = 40;
+    static constexpr int MaxHand = 10;
+    static constexpr int MaxLands = 16;
+    static constexpr int MaxCreatures = 16;
+    static constexpr int MaxEnchantments = 8;
+    static constexpr int MaxDiscard = MaxLibrary;
+
+    int hp;
+    int manaPool[5]; // in CardColor order, like the pools of the Mana class
+    bool landPlayed;
+
+    int libraryCount; // the top of the library is the last card, like library1.back() in main()
+    int landCount;
+    int creatureCount;
+    int enchantmentCount;
+    int discardCount;
+    std::uint64_t zoneHash; // sum of GameState::zoneKey() of every card in the zones above, kept up to date by the engine
+
+    CardId library[MaxLibrary];
+    StaticVector<CardId, MaxHand> hand;
+    CardId lands[MaxLands];
+    CreatureSlot creatures[MaxCreatures];
+    CardId enchantments[MaxEnchantments];
+    CardId discard[MaxDiscard];
+}; // PlayerState struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief The decision points of a turn. Draw, untap and end phases need no decision and run inside applyMove().
+ */
+enum class Phase : std::uint8_t
+{
+    Main1,
+    Attack,
+    Block,
+    Main2,
+    GameOver
+};
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief The kinds of decision a player can make.
+ */
+enum class MoveKind : std::uint8_t
+{
+    Pass,     // end the play phase, finish the attack squad or leave the current attacker unblocked
+    PlayCard, // slot is the hand index, target depends on the card's effect
+    Attack,   // slot is the creature joining the attack squad
+    Block     // slot is the creature blocking the current attacker
+};
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct Move
+ * @brief One decision of a player in the headless engine.
+ *
+ * For PlayCard the target is a creature, land or enchantment index of the affected player, a discard index for
+ * Reanimate, TargetPlayer for LightningBolt at the opponent, or TargetNone.
+ */
+struct Move
+{
+    static constexpr std::uint8_t TargetNone = 0xff;
+    static constexpr std::uint8_t TargetPlayer = 0xfe;
+
+    MoveKind kind;
+    std::uint8_t slot;
+    std::uint8_t target;
+
+    bool operator==(const Move &o) const { return kind == o.kind && slot == o.slot && target == o.target; }
+    bool operator!=(const Move &o) const { return !(*this == o); }
+}; // Move struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class GameState
+ * @brief A headless, value-type copy of the game rules that plays without std::cin or std::cout.
+ *
+ * The interactive loop in main() asks stdin for every decision, so search and AI code runs on this engine instead.
+ * It follows the same turn structure (draw, untap, play, combat, second play, end) and card effects, with the rules
+ * main() intends: colored and generic mana are both paid, sorceries go to the discard pile after they resolve,
+ * LightningBolt hits one target, lands are free to play (one per turn), and damage on creatures heals at the end of
+ * every turn. Enhancement cards change the creatures in play once when they are played and are reversed when they
+ * are destroyed by Disenchant.
+ *
+ * The attack squad is built one creature at a time in slot order and blocks are chosen one attacker at a time, so
+ * every decision has a small move list. The whole state is trivially copyable.
+ */
+class GameState
+{
+public:
+    static constexpr int MaxMoves = 1 + PlayerState::MaxHand * (PlayerState::MaxDiscard + 1) + PlayerState::MaxCreatures;
+
+    PlayerState players[2];
+    int active;     // player whose turn it is
+    Phase phase;
+    int turn;       // round counter, increased when player 1 starts a new turn like turnCounter in main()
+    int winner;     // -1 while the game is running
+    std::uint32_t attackers;       // creature slots of the active player in the attack squad
+    std::uint32_t usedBlockers;    // creature slots of the defender that already block
+    int blockCursor;               // attacker slot whose blocker is being chosen
+    std::int8_t blockers[PlayerState::MaxCreatures]; // blocker slot for every attacker slot, -1 for none
+    std::uint64_t rng;
+    std::uint64_t turnHash; // hash chain of the state at the end of every turn so far
+    const CardTable *table; // card pool the game was dealt from; every copy of the state keeps reading it
+    GameRules rules;
+
+    /**
+     * @brief Whether the engine can play a format: hp fits the state format and the hands and decks fit the zones.
+     */
+    static constexpr bool supportsRules(const GameRules &r)
+    {
+        return r.startingHp > 0 && r.startingHp <= 127 && r.handLimit > 0 && r.handLimit <= PlayerState::MaxHand && r.openingHand >= 0 &&
+               r.openingHand <= r.handLimit && r.deckSize > 0 && r.deckSize <= PlayerState::MaxLibrary && r.attackSquadSize > 0 &&
+               r.attackSquadSize <= 255;
+    }
+
+    /**
+     * @brief Starts a new game with the two decks of the active card table.
+     *
+     * @param seed Seed of the shuffle.
+     * @return False if the decks do not fit the standard format; see the full overload.
+     */
+    bool reset(std::uint64_t seed) { return reset(seed, getActiveCardTable()); }
+
+    /**
+     * @brief Starts a new game with the two decks of a card table, such as a CardTableLease snapshot.
+     *
+     * @param seed Seed of the shuffle.
+     * @param cardTable Card pool of the game; it must outlive the game and every copy of it.
+     * @param gameRules The format; it must pass supportsRules().
+     * @return False if the decks do not fit the format; see the full overload.
+     */
+    bool reset(std::uint64_t seed, const CardTable &cardTable, const GameRules &gameRules = StandardRules)
+    {
+        return reset(seed, cardTable, cardTable.decks[0], cardTable.deckSizes[0], cardTable.decks[1], cardTable.deckSizes[1], gameRules);
+    }
+
+    /**
+     * @brief Starts a new game with the cards of the active card table and the given decks.
+     */
+    bool reset(std::uint64_t seed, const CardId *deck1, int size1, const CardId *deck2, int size2)
+    {
+        return reset(seed, getActiveCardTable(), deck1, size1, deck2, size2);
+    }
+
+    /**
+     * @brief Starts a new game: shuffles both decks, deals the opening hands and starts player 1's first turn.
+     *
+     * @param seed Seed of the shuffle.
+     * @param cardTable Card pool of the game; it must outlive the game and every copy of it.
+     * @param deck1 Card ids of player 1's library.
+     * @param size1 Number of cards in deck1.
+     * @param deck2 Card ids of player 2's library.
+     * @param size2 Number of cards in deck2.
+     * @param gameRules The format; it must pass supportsRules().
+     * @return False if the format is not supported or a deck does not hold exactly gameRules.deckSize cards. The game
+     * is still dealt, with every library cut to deckSize cards, so a caller that only plays on stays in bounds.
+     */
+    bool reset(std::uint64_t seed, const CardTable &cardTable, const CardId *deck1, int size1, const CardId *deck2, int size2,
+               const GameRules &gameRules = StandardRules)
+    {
+        std::memset(static_cast<void *>(this), 0, sizeof(GameState));
+        table = &cardTable;
+        rules = gameRules;
+        rules.handLimit = rules.handLimit < PlayerState::MaxHand ? rules.handLimit : PlayerState::MaxHand; // never write past the hand
+        rng = seed ? seed : 0x9e3779b97f4a7c15ull;
+
+        const CardId *decks[2] = {deck1, deck2};
+        const int sizes[2] = {size1, size2};
+
+        for (int p = 0; p < 2; p++)
+        {
+            if (rules == StandardRules && sizes[p] == StandardRules.deckSize)
+            {
+                setUpPlayer(StaticRules<StandardRules>(), players[p], decks[p], StandardRules.deckSize);
+            }
+            else
+            {
+                setUpPlayer(rules, players[p], decks[p], sizes[p] < rules.deckSize ? sizes[p] : rules.deckSize);
+            }
+        }
+
+        active = 0;
+        turn = 1;
+        winner = -1;
+        turnHash = rng;
+        clearCombat();
+        startTurn();
+        return supportsRules(gameRules) && size1 == rules.deckSize && size2 == rules.deckSize;
+    }
+
+    /**
+     * @brief Returns the player who has to make the next decision.
+     */
+    int toMove() const { return phase == Phase::Block ? 1 - active : active; }
+
+    /**
+     * @brief Checks whether the game has ended.
+     */
+    bool isOver() const { return phase == Phase::GameOver; }
+
+    /**
+     * @brief Writes every legal move of the player to move into out.
+     *
+     * @param out Buffer of at least MaxMoves moves.
+     * @return The number of moves written, 0 when the game is over.
+     */
+    int generateMoves(Move *out) const
+    {
+        int n = 0;
+
+        if (phase == Phase::GameOver)
+        {
+            return 0;
+        }
+
+        out[n++] = Move{MoveKind::Pass, 0, Move::TargetNone};
+
+        if (phase == Phase::Main1 || phase == Phase::Main2)
+        {
+            const PlayerState &me = players[active];
+            const PlayerState &op = players[1 - active];
+
+            for (int h = 0; h < me.hand.size(); h++)
+            {
+                // identical cards in hand give identical moves, only the first copy is offered
+                bool seen = false;
+                for (int k = 0; k < h; k++)
+                {
+                    if (me.hand[k] == me.hand[h])
+                    {
+                        seen = true;
+                    }
+                }
+                if (seen || !canPay(me, prototype(me.hand[h])))
+                {
+                    continue;
+                }
+
+                const CardPrototype &proto = prototype(me.hand[h]);
+                const std::uint8_t slot = static_cast<std::uint8_t>(h);
+
+                switch (proto.kind)
+                {
+                case CardKind::Land:
+                    if (!me.landPlayed && me.landCount < PlayerState::MaxLands)
+                    {
+                        out[n++] = Move{MoveKind::PlayCard, slot, Move::TargetNone};
+                    }
+                    break;
+                case CardKind::Creature:
+                    if (me.creatureCount < PlayerState::MaxCreatures)
+                    {
+                        out[n++] = Move{MoveKind::PlayCard, slot, Move::TargetNone};
+                    }
+                    break;
+                case CardKind::Enhancement:
+                    if (me.enchantmentCount >= PlayerState::MaxEnchantments)
+                    {
+                        break;
+                    }
+                    // enhancement targets work like sorcery targets
+                    [[fallthrough]];
+                case CardKind::Sorcery:
+                    n = addTargetedMoves(out, n, slot, proto.effect, me, op);
+                    break;
+                }
+            }
+        }
+        else if (phase == Phase::Attack)
+        {
+            const PlayerState &me = players[active];
+
+            // the squad is built in slot order so every squad is reached once, up to the format's squad size
+            for (int c = highestAttacker() + 1; c < me.creatureCount && getAttackerCount() < rules.attackSquadSize; c++)
+            {
+                if (!me.creatures[c].tapped)
+                {
+                    out[n++] = Move{MoveKind::Attack, static_cast<std::uint8_t>(c), Move::TargetNone};
+                }
+            }
+        }
+        else if (phase == Phase::Block)
+        {
+            const PlayerState &defender = players[1 - active];
+
+            for (int c = 0; c < defender.creatureCount; c++)
+            {
+                if (!defender.creatures[c].tapped && !(usedBlockers & (1u << c)))
+                {
+                    out[n++] = Move{MoveKind::Block, static_cast<std::uint8_t>(c), Move::TargetNone};
+                }
+            }
+        }
+
+        return n;
+    }
+
+    /**
+     * @brief Plays one decision of the player to move and runs the game forward to the next decision.
+     *
+     * @param m A move produced by generateMoves() for this state.
+     */
+    void applyMove(const Move &m)
+    {
+        switch (phase)
+        {
+        case Phase::Main1:
+        case Phase::Main2:
+            if (m.kind == MoveKind::PlayCard)
+            {
+                playCard(m.slot, m.target);
+            }
+            else if (phase == Phase::Main1)
+            {
+                phase = hasUntappedCreature(players[active]) ? Phase::Attack : Phase::Main2;
+            }
+            else
+            {
+                endTurn();
+            }
+            break;
+
+        case Phase::Attack:
+            if (m.kind == MoveKind::Attack)
+            {
+                attackers |= 1u << m.slot;
+                players[active].creatures[m.slot].tapped = true;
+            }
+            else if (attackers == 0)
+            {
+                phase = Phase::Main2;
+            }
+            else
+            {
+                phase = Phase::Block;
+                blockCursor = nextAttacker(-1);
+            }
+            break;
+
+        case Phase::Block:
+            if (m.kind == MoveKind::Block)
+            {
+                blockers[blockCursor] = static_cast<std::int8_t>(m.slot);
+                usedBlockers |= 1u << m.slot;
+            }
+            blockCursor = nextAttacker(blockCursor);
+            if (blockCursor < 0)
+            {
+                resolveCombat();
+            }
+            break;
+
+        case Phase::GameOver:
+            break;
+        }
+    }
+
+    /**
+     * @brief Returns the attacker whose blocker is being chosen in the Block phase.
+     */
+    int getBlockCursor() const { return blockCursor; }
+
+    /**
+     * @brief Returns the number of creatures in the attack squad.
+     */
+    int getAttackerCount() const
+    {
+        int count = 0;
+        for (std::uint32_t a = attackers; a != 0; a &= a - 1)
+        {
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Returns the damage the LightningBolts in the active player's hand can still deal to the opponent this
+     * turn, each paid from what the ones before it left in the pool.
+     */
+    int getBurnDamage() const
+    {
+        PlayerState me = players[active];
+        int burn = 0;
+
+        for (int h = 0; h < me.hand.size(); h++)
+        {
+            const CardPrototype &proto = prototype(me.hand[h]);
+            if (proto.effect == EffectKind::LightningBolt && canPay(me, proto))
+            {
+                pay(me, proto);
+                burn -= proto.effectHp;
+            }
+        }
+        return burn;
+    }
+
+    /**
+     * @brief Returns the turn hash chain: every endTurn() folds a digest of the state into it.
+     *
+     * Two copies of a game that stay in sync have the same chain after every turn, so a replay or a remote peer sees
+     * a divergence within one turn. The digest is built from zone hashes that are updated on every card movement, so
+     * only the hp, mana, creature stats and a few flags are read when a turn ends.
+     */
+    std::uint64_t getTurnHash() const { return turnHash; }
+
+    /**
+     * @brief Returns the card pool the game was dealt from.
+     */
+    const CardTable &getCardTable() const { return *table; }
+
+    /**
+     * @brief Looks up the prototype of a card id in the game's card pool.
+     */
+    const CardPrototype &prototype(CardId id) const { return table->cards[id]; }
+
+    /**
+     * @brief Hash term of one card in one zone of its owner; the zone hash of a player is the sum of its cards' terms.
+     */
+    static std::uint64_t zoneKey(int zone, CardId card)
+    {
+        std::uint64_t z = (static_cast<std::uint64_t>(zone) << 16 | card) + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Recomputes both zone hashes from the zones, for states that were built or loaded from outside the engine.
+     */
+    void rebuildZoneHashes()
+    {
+        for (PlayerState &ps : players)
+        {
+            const CardId *zones[] = {ps.library, ps.hand.data(), ps.lands, nullptr, ps.enchantments, ps.discard};
+            const int counts[] = {ps.libraryCount, ps.hand.size(), ps.landCount, ps.creatureCount, ps.enchantmentCount, ps.discardCount};
+
+            ps.zoneHash = 0;
+            for (int z = LibraryZone; z <= DiscardZone; z++)
+            {
+                for (int i = 0; i < counts[z]; i++)
+                {
+                    ps.zoneHash += zoneKey(z, z == CreatureZone ? ps.creatures[i].card : zones[z][i]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Hashes the full state by walking every zone.
+     */
+    std::uint64_t hash() const
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](std::uint64_t v)
+        {
+            h ^= v;
+            h *= 1099511628211ull;
+        };
+
+        for (int p = 0; p < 2; p++)
+        {
+            const PlayerState &ps = players[p];
+            mix(static_cast<std::uint64_t>(ps.hp) + 0x100);
+            for (int c = 0; c < 5; c++)
+            {
+                mix(static_cast<std::uint64_t>(ps.manaPool[c]));
+            }
+            mix(ps.landPlayed);
+            mix(0x200 + ps.libraryCount);
+            for (int i = 0; i < ps.libraryCount; i++)
+            {
+                mix(ps.library[i]);
+            }
+            mix(0x300 + ps.hand.size());
+            for (int i = 0; i < ps.hand.size(); i++)
+            {
+                mix(ps.hand[i]);
+            }
+            mix(0x400 + ps.landCount);
+            for (int i = 0; i < ps.landCount; i++)
+            {
+                mix(ps.lands[i]);
+            }
+            mix(0x500 + ps.creatureCount);
+            for (int i = 0; i < ps.creatureCount; i++)
+            {
+                const CreatureSlot &cs = ps.creatures[i];
+                mix(cs.card);
+                mix(static_cast<std::uint8_t>(cs.attack) | static_cast<std::uint8_t>(cs.hp) << 8 |
+                    static_cast<std::uint8_t>(cs.toughness) << 16 | cs.firstStrike << 24 | cs.trample << 25 | cs.tapped << 26);
+            }
+            mix(0x600 + ps.enchantmentCount);
+            for (int i = 0; i < ps.enchantmentCount; i++)
+            {
+                mix(ps.enchantments[i]);
+            }
+            mix(0x700 + ps.discardCount);
+            for (int i = 0; i < ps.discardCount; i++)
+            {
+                mix(ps.discard[i]);
+            }
+        }
+        mix(static_cast<std::uint64_t>(active) | static_cast<std::uint64_t>(phase) << 8 | static_cast<std::uint64_t>(blockCursor + 1) << 16);
+        mix(attackers);
+        mix(usedBlockers);
+        for (int i = 0; i < PlayerState::MaxCreatures; i++)
+        {
+            mix(static_cast<std::uint8_t>(blockers[i]));
+        }
+        return h;
+    }
+
+private:
+    enum : int
+    {
+        NoZone = -1,
+        LibraryZone,
+        HandZone,
+        LandZone,
+        CreatureZone,
+        EnchantmentZone,
+        DiscardZone
+    };
+
+    // Keep the zone hash in step with a card moving between two zones (NoZone when it comes from or goes nowhere)
+    static void hashMove(PlayerState &ps, int from, int to, CardId card)
+    {
+        if (from != NoZone)
+        {
+            ps.zoneHash -= zoneKey(from, card);
+        }
+        if (to != NoZone)
+        {
+            ps.zoneHash += zoneKey(to, card);
+        }
+    }
+
+    // Fold the end-of-turn state into the hash chain; the zones are already summed up in zoneHash
+    void commitTurnHash()
+    {
+        std::uint64_t h = turnHash ^ rng;
+        auto mix = [&h](std::uint64_t v)
+        {
+            h = (h ^ v) * 0x9fb21c651e98df25ull;
+            h ^= h >> 29;
+        };
+
+        for (const PlayerState &ps : players)
+        {
+            mix(ps.zoneHash);
+            mix(static_cast<std::uint64_t>(static_cast<std::uint32_t>(ps.hp)) | static_cast<std::uint64_t>(ps.landPlayed) << 32);
+            for (int c = 0; c < 5; c++)
+            {
+                mix(static_cast<std::uint64_t>(ps.manaPool[c]) << (8 * c));
+            }
+            for (int c = 0; c < ps.creatureCount; c++)
+            {
+                const CreatureSlot &cs = ps.creatures[c];
+                mix(static_cast<std::uint64_t>(cs.card) | static_cast<std::uint64_t>(static_cast<std::uint8_t>(cs.attack)) << 16 |
+                    static_cast<std::uint64_t>(static_cast<std::uint8_t>(cs.hp)) << 24 | static_cast<std::uint64_t>(static_cast<std::uint8_t>(cs.toughness)) << 32 |
+                    static_cast<std::uint64_t>(cs.firstStrike) << 40 | static_cast<std::uint64_t>(cs.trample) << 41 | static_cast<std::uint64_t>(cs.tapped) << 42);
+            }
+        }
+        mix(static_cast<std::uint64_t>(active) | static_cast<std::uint64_t>(turn) << 8);
+        turnHash = h;
+    }
+
+    std::uint64_t nextRandom()
+    {
+        // xorshift64*
+        rng ^= rng >> 12;
+        rng ^= rng << 25;
+        rng ^= rng >> 27;
+        return rng * 2685821657736338717ull;
+    }
+
+    static bool canPay(const PlayerState &ps, const CardPrototype &proto)
+    {
+        int total = 0;
+        int required = proto.generic;
+
+        for (int c = 0; c < 5; c++)
+        {
+            if (ps.manaPool[c] < proto.cost[c])
+            {
+                return false;
+            }
+            total += ps.manaPool[c];
+            required += proto.cost[c];
+        }
+        return total >= required;
+    }
+
+    static void pay(PlayerState &ps, const CardPrototype &proto)
+    {
+        for (int c = 0; c < 5; c++)
+        {
+            ps.manaPool[c] -= proto.cost[c];
+        }
+        // generic mana comes out of the largest pool first
+        for (int g = 0; g < proto.generic; g++)
+        {
+            int largest = 0;
+            for (int c = 1; c < 5; c++)
+            {
+                if (ps.manaPool[c] > ps.manaPool[largest])
+                {
+                    largest = c;
+                }
+            }
+            ps.manaPool[largest]--;
+        }
+    }
+
+    static bool hasUntappedCreature(const PlayerState &ps)
+    {
+        for (int c = 0; c < ps.creatureCount; c++)
+        {
+            if (!ps.creatures[c].tapped)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int highestAttacker() const
+    {
+        int highest = -1;
+        for (int c = 0; c < PlayerState::MaxCreatures; c++)
+        {
+            if (attackers & (1u << c))
+            {
+                highest = c;
+            }
+        }
+        return highest;
+    }
+
+    int nextAttacker(int after) const
+    {
+        for (int c = after + 1; c < PlayerState::MaxCreatures; c++)
+        {
+            if (attackers & (1u << c))
+            {
+                return c;
+            }
+        }
+        return -1;
+    }
+
+    int addTargetedMoves(Move *out, int n, std::uint8_t slot, EffectKind effect, const PlayerState &me, const PlayerState &op) const
+    {
+        const int before = n;
+
+        switch (effect)
+        {
+        case EffectKind::Disenchant:
+            for (int i = 0; i < op.enchantmentCount; i++)
+            {
+                out[n++] = Move{MoveKind::PlayCard, slot, static_cast<std::uint8_t>(i)};
+            }
+            break;
+        case EffectKind::LightningBolt:
+            out[n++] = Move{MoveKind::PlayCard, slot, Move::TargetPlayer};
+            for (int i = 0; i < op.creatureCount; i++)
+            {
+                out[n++] = Move{MoveKind::PlayCard, slot, static_cast<std::uint8_t>(i)};
+            }
+            break;
+        case EffectKind::Flood:
+            for (int i = 0; i < op.landCount; i++)
+            {
+                out[n++] = Move{MoveKind::PlayCard, slot, static_cast<std::uint8_t>(i)};
+            }
+            break;
+        case EffectKind::Reanimate:
+            if (me.hand.size() < rules.handLimit)
+            {
+                for (int i = 0; i < me.discardCount; i++)
+                {
+                    if (prototype(me.discard[i]).kind == CardKind::Creature)
+                    {
+                        out[n++] = Move{MoveKind::PlayCard, slot, static_cast<std::uint8_t>(i)};
+                    }
+                }
+            }
+            break;
+        case EffectKind::Terror:
+        case EffectKind::Slow:
+            for (int i = 0; i < op.creatureCount; i++)
+            {
+                out[n++] = Move{MoveKind::PlayCard, slot, static_cast<std::uint8_t>(i)};
+            }
+            break;
+        case EffectKind::Rage:
+            for (int i = 0; i < me.creatureCount; i++)
+            {
+                out[n++] = Move{MoveKind::PlayCard, slot, static_cast<std::uint8_t>(i)};
+            }
+            break;
+        default:
+            out[n++] = Move{MoveKind::PlayCard, slot, Move::TargetNone};
+            break;
+        }
+
+        // like in main(), a card without a target can still be played and is wasted
+        if (n == before)
+        {
+            out[n++] = Move{MoveKind::PlayCard, slot, Move::TargetNone};
+        }
+        return n;
+    }
+
+    void startTurn()
+    {
+        PlayerState &me = players[active];
+
+        // draw phase
+        if (me.libraryCount == 0)
+        {
+            finish(1 - active);
+            return;
+        }
+        const CardId drawn = me.library[--me.libraryCount];
+        me.library[me.libraryCount] = 0;
+        if (me.hand.size() < rules.handLimit)
+        {
+            me.hand.push_back(drawn);
+            hashMove(me, LibraryZone, HandZone, drawn);
+        }
+        else
+        {
+            me.discard[me.discardCount++] = drawn;
+            hashMove(me, LibraryZone, DiscardZone, drawn);
+        }
+
+        // untap phase, every land is tapped for mana right away like in main()
+        for (int c = 0; c < me.creatureCount; c++)
+        {
+            me.creatures[c].tapped = false;
+        }
+        for (int l = 0; l < me.landCount; l++)
+        {
+            me.manaPool[static_cast<int>(prototype(me.lands[l]).color)]++;
+        }
+        me.landPlayed = false;
+        phase = Phase::Main1;
+    }
+
+    void endTurn()
+    {
+        commitTurnHash();
+        for (int p = 0; p < 2; p++)
+        {
+            for (int c = 0; c < players[p].creatureCount; c++)
+            {
+                players[p].creatures[c].hp = players[p].creatures[c].toughness;
+            }
+        }
+        for (int c = 0; c < 5; c++)
+        {
+            players[active].manaPool[c] = 0;
+        }
+
+        active = 1 - active;
+        if (active == 0)
+        {
+            turn++;
+        }
+        startTurn();
+    }
+
+    void finish(int winningPlayer)
+    {
+        winner = winningPlayer;
+        phase = Phase::GameOver;
+    }
+
+    // End the game if a player is out of hp
+    void checkPlayers()
+    {
+        const bool dead0 = players[0].hp <= 0;
+        const bool dead1 = players[1].hp <= 0;
+
+        if (dead0 || dead1)
+        {
+            // when both die at once the player whose turn it is loses, like printLoser in main()
+            finish(dead0 && dead1 ? 1 - active : (dead0 ? 1 : 0));
+        }
+    }
+
+    static void removeCard(CardId *zone, int &count, int index)
+    {
+        for (int i = index; i + 1 < count; i++)
+        {
+            zone[i] = zone[i + 1];
+        }
+        zone[--count] = 0;
+    }
+
+    static void removeCreature(PlayerState &ps, int index)
+    {
+        for (int i = index; i + 1 < ps.creatureCount; i++)
+        {
+            ps.creatures[i] = ps.creatures[i + 1];
+        }
+        ps.creatures[--ps.creatureCount] = CreatureSlot{};
+    }
+
+    // Move dead creatures to their owner's discard pile
+    static void buryDead(PlayerState &ps)
+    {
+        for (int c = ps.creatureCount - 1; c >= 0; c--)
+        {
+            if (ps.creatures[c].hp < 1)
+            {
+                ps.discard[ps.discardCount++] = ps.creatures[c].card;
+                hashMove(ps, CreatureZone, DiscardZone, ps.creatures[c].card);
+                removeCreature(ps, c);
+            }
+        }
+    }
+
+    void boostColor(PlayerState &ps, CardColor color, int attack, int hp) const
+    {
+        for (int c = 0; c < ps.creatureCount; c++)
+        {
+            CreatureSlot &cs = ps.creatures[c];
+            if (prototype(cs.card).color == color)
+            {
+                cs.attack = static_cast<std::int8_t>(cs.attack + attack);
+                cs.hp = static_cast<std::int8_t>(cs.hp + hp);
+                cs.toughness = static_cast<std::int8_t>(cs.toughness + hp);
+            }
+        }
+        buryDead(ps);
+    }
+
+    // Undo an enhancement card that Disenchant destroys; owner is the player who played it
+    void reverseEnhancement(const CardPrototype &enhancement, PlayerState &owner, PlayerState &other)
+    {
+        switch (enhancement.effect)
+        {
+        case EffectKind::Rage:
+            for (int c = 0; c < owner.creatureCount; c++)
+            {
+                owner.creatures[c].trample = prototype(owner.creatures[c].card).trample;
+            }
+            break;
+        case EffectKind::HolyWar:
+            boostColor(owner, CardColor::White, -enhancement.effectAttack, -enhancement.effectHp);
+            break;
+        case EffectKind::HolyLight:
+            boostColor(other, CardColor::Black, -enhancement.effectAttack, -enhancement.effectHp);
+            break;
+        case EffectKind::UnholyWar:
+            // the attack bonus is taken back without going below 0
+            for (int c = 0; c < owner.creatureCount; c++)
+            {
+                CreatureSlot &cs = owner.creatures[c];
+                if (prototype(cs.card).color == CardColor::Black && cs.attack > 0)
+                {
+                    cs.attack = static_cast<std::int8_t>(cs.attack > enhancement.effectAttack ? cs.attack - enhancement.effectAttack : 0);
+                }
+            }
+            boostColor(owner, CardColor::Black, 0, -enhancement.effectHp);
+            break;
+        case EffectKind::Restrain:
+            for (int c = 0; c < other.creatureCount; c++)
+            {
+                if (prototype(other.creatures[c].card).color == CardColor::Green)
+                {
+                    other.creatures[c].trample = prototype(other.creatures[c].card).trample;
+                }
+            }
+            break;
+        case EffectKind::Slow:
+            for (int c = 0; c < other.creatureCount; c++)
+            {
+                other.creatures[c].firstStrike = prototype(other.creatures[c].card).firstStrike;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void playCard(int handIndex, std::uint8_t target)
+    {
+        PlayerState &me = players[active];
+        PlayerState &op = players[1 - active];
+        const CardId id = me.hand[handIndex];
+        const CardPrototype &proto = prototype(id);
+
+        pay(me, proto);
+        me.hand.erase(handIndex);
+
+        switch (proto.kind)
+        {
+        case CardKind::Land:
+            me.lands[me.landCount++] = id;
+            me.manaPool[static_cast<int>(proto.color)]++;
+            me.landPlayed = true;
+            hashMove(me, HandZone, LandZone, id);
+            return;
+        case CardKind::Creature:
+            me.creatures[me.creatureCount++] = CreatureSlot{id, proto.attack, proto.hp, proto.hp, proto.firstStrike, proto.trample, false};
+            hashMove(me, HandZone, CreatureZone, id);
+            return;
+        case CardKind::Sorcery:
+            me.discard[me.discardCount++] = id;
+            hashMove(me, HandZone, DiscardZone, id);
+            break;
+        case CardKind::Enhancement:
+            me.enchantments[me.enchantmentCount++] = id;
+            hashMove(me, HandZone, EnchantmentZone, id);
+            break;
+        }
+
+        if (target == Move::TargetNone && proto.effect != EffectKind::Plague && proto.effect != EffectKind::HolyWar &&
+            proto.effect != EffectKind::HolyLight && proto.effect != EffectKind::UnholyWar && proto.effect != EffectKind::Restrain)
+        {
+            return; // no target, the card is wasted
+        }
+
+        switch (proto.effect)
+        {
+        case EffectKind::Disenchant:
+        {
+            const CardId destroyed = op.enchantments[target];
+            removeCard(op.enchantments, op.enchantmentCount, target);
+            op.discard[op.discardCount++] = destroyed;
+            hashMove(op, EnchantmentZone, DiscardZone, destroyed);
+            reverseEnhancement(prototype(destroyed), op, me);
+            break;
+        }
+        case EffectKind::LightningBolt:
+            if (target == Move::TargetPlayer)
+            {
+                op.hp += proto.effectHp;
+                checkPlayers();
+            }
+            else
+            {
+                op.creatures[target].hp = static_cast<std::int8_t>(op.creatures[target].hp + proto.effectHp);
+                buryDead(op);
+            }
+            break;
+        case EffectKind::Flood:
+            op.discard[op.discardCount++] = op.lands[target];
+            hashMove(op, LandZone, DiscardZone, op.lands[target]);
+            removeCard(op.lands, op.landCount, target);
+            break;
+        case EffectKind::Reanimate:
+            me.hand.push_back(me.discard[target]);
+            hashMove(me, DiscardZone, HandZone, me.discard[target]);
+            removeCard(me.discard, me.discardCount, target);
+            break;
+        case EffectKind::Plague:
+            for (int c = 0; c < op.creatureCount; c++)
+            {
+                op.creatures[c].hp = static_cast<std::int8_t>(op.creatures[c].hp + proto.effectHp);
+            }
+            buryDead(op);
+            break;
+        case EffectKind::Terror:
+            op.creatures[target].hp = 0;
+            buryDead(op);
+            break;
+        case EffectKind::Rage:
+            me.creatures[target].trample = true;
+            break;
+        case EffectKind::HolyWar:
+            boostColor(me, CardColor::White, proto.effectAttack, proto.effectHp);
+            break;
+        case EffectKind::HolyLight:
+            boostColor(op, CardColor::Black, proto.effectAttack, proto.effectHp);
+            break;
+        case EffectKind::UnholyWar:
+            boostColor(me, CardColor::Black, proto.effectAttack, proto.effectHp);
+            break;
+        case EffectKind::Restrain:
+            for (int c = 0; c < op.creatureCount; c++)
+            {
+                if (prototype(op.creatures[c].card).color == CardColor::Green)
+                {
+                    op.creatures[c].trample = false;
+                }
+            }
+            break;
+        case EffectKind::Slow:
+            op.creatures[target].firstStrike = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Fill and shuffle one player's library and deal the opening hand. R is GameRules or a StaticRules; with a
+    // StaticRules the limits are constants and the standard setup runs with fixed trip counts
+    template <typename R>
+    void setUpPlayer(const R &r, PlayerState &ps, const CardId *deck, int size)
+    {
+        ps.hp = r.startingHp;
+        for (int c = 0; c < 5; c++)
+        {
+            ps.manaPool[c] = 1; // a new Mana object starts with one of every color
+        }
+
+        ps.libraryCount = size < PlayerState::MaxLibrary ? size : PlayerState::MaxLibrary;
+        for (int i = 0; i < ps.libraryCount; i++)
+        {
+            ps.library[i] = deck[i];
+            hashMove(ps, NoZone, LibraryZone, ps.library[i]);
+        }
+        for (int i = ps.libraryCount - 1; i > 0; i--)
+        {
+            const int j = static_cast<int>(nextRandom() % static_cast<std::uint64_t>(i + 1));
+            std::swap(ps.library[i], ps.library[j]);
+        }
+        for (int i = 0; i < r.openingHand && ps.libraryCount > 0 && !ps.hand.full(); i++)
+        {
+            ps.hand.push_back(ps.library[--ps.libraryCount]);
+            hashMove(ps, LibraryZone, HandZone, ps.hand.back());
+        }
+    }
+
+    void clearCombat()
+    {
+        attackers = 0;
+        usedBlockers = 0;
+        blockCursor = -1;
+        for (int i = 0; i < PlayerState::MaxCreatures; i++)
+        {
+            blockers[i] = -1;
+        }
+    }
+
+    void resolveCombat()
+    {
+        PlayerState &me = players[active];
+        PlayerState &op = players[1 - active];
+
+        for (int a = 0; a < me.creatureCount; a++)
+        {
+            if (!(attackers & (1u << a)))
+            {
+                continue;
+            }
+
+            CreatureSlot &attacker = me.creatures[a];
+            if (blockers[a] < 0)
+            {
+                op.hp -= attacker.attack > 0 ? attacker.attack : 0;
+                continue;
+            }
+
+            CreatureSlot &blocker = op.creatures[blockers[a]];
+            const CombatOutcome r = CombatTable::lookup(CreatureStats{attacker.attack, attacker.hp, attacker.firstStrike, attacker.trample},
+                                                        CreatureStats{blocker.attack, blocker.hp, blocker.firstStrike, blocker.trample});
+            attacker.hp = static_cast<std::int8_t>(r.attackerDies ? 0 : r.attackerHpLeft);
+            blocker.hp = static_cast<std::int8_t>(r.blockerDies ? 0 : r.blockerHpLeft);
+            op.hp -= r.trampleDamage;
+        }
+
+        buryDead(me);
+        buryDead(op);
+        clearCombat();
+        phase = Phase::Main2;
+        checkPlayers();
+    }
+}; // GameState class
+
+static_assert(GameState::supportsRules(StandardRules), "the standard format must fit the engine's zones");
+static_assert(std::is_trivially_copyable<GameState>::value, "states are copied and hashed as plain bytes");
+//======================================================================================================================
+// Fixed numbering of every move of the headless engine, the same for every state
+constexpr int TargetSlots = 2 + PlayerState::MaxDiscard;
+constexpr int AttackActionBase = 1 + PlayerState::MaxHand * TargetSlots;
+constexpr int BlockActionBase = AttackActionBase + PlayerState::MaxCreatures;
+constexpr int ActionCount = BlockActionBase + PlayerState::MaxCreatures;
+//----------------------------------------------------------------------------------------------------------------------
+// Map a move to its fixed action number
+inline int actionIndex(const Move &m)
+{
+    switch (m.kind)
+    {
+    case MoveKind::PlayCard:
+    {
+        const int targetSlot = m.target == Move::TargetNone ? 0 : (m.target == Move::TargetPlayer ? 1 : 2 + m.target);
+        return 1 + m.slot * TargetSlots + targetSlot;
+    }
+    case MoveKind::Attack:
+        return AttackActionBase + m.slot;
+    case MoveKind::Block:
+        return BlockActionBase + m.slot;
+    default:
+        return 0;
+    }
+} // actionIndex function
+//----------------------------------------------------------------------------------------------------------------------
+// Cheap static score of a position for the given player, used at the search horizon
+int evaluateState(const GameState &s, int player)
+{
+    int score = 0;
+
+    for (int p = 0; p < 2; p++)
+    {
+        const PlayerState &ps = s.players[p];
+        int side = ps.hp * 10 + ps.landCount * 2 + ps.hand.size();
+
+        for (int c = 0; c < ps.creatureCount; c++)
+        {
+            side += 3 * (ps.creatures[c].attack + ps.creatures[c].toughness);
+        }
+        score += p == player ? side : -side;
+    }
+    return score;
+} // evaluateState function
+//----------------------------------------------------------------------------------------------------------------------
+// Check whether the active player of an Attack phase kills the opponent whatever the blocks, by attacking with the
+// squad so far plus every creature it can still add and casting its LightningBolts at the opponent afterwards
+bool hasLethalAttack(const GameState &s)
+{
+    if (s.phase != Phase::Attack)
+    {
+        return false;
+    }
+
+    const PlayerState &me = s.players[s.active];
+    const PlayerState &op = s.players[1 - s.active];
+    BlockSolver::CreatureList attackers;
+    BlockSolver::CreatureList defenders;
+
+    // the squad grows in slot order, so only untapped creatures above its highest slot can still join
+    int highest = -1;
+    for (int c = 0; c < me.creatureCount; c++)
+    {
+        if (s.attackers & (1u << c))
+        {
+            highest = c;
+        }
+    }
+
+    for (int c = 0; c < me.creatureCount; c++)
+    {
+        const bool inSquad = (s.attackers & (1u << c)) != 0;
+        const bool canJoin = c > highest && !me.creatures[c].tapped && static_cast<int>(attackers.size()) < s.rules.attackSquadSize;
+        if (inSquad || canJoin)
+        {
+            const CreatureSlot &cs = me.creatures[c];
+            attackers.push_back(CreatureStats{cs.attack, cs.hp, cs.firstStrike, cs.trample});
+        }
+    }
+    for (int c = 0; c < op.creatureCount; c++)
+    {
+        if (!op.creatures[c].tapped)
+        {
+            const CreatureSlot &cs = op.creatures[c];
+            defenders.push_back(CreatureStats{cs.attack, cs.hp, cs.firstStrike, cs.trample});
+        }
+    }
+
+    LethalSolver solver;
+    return solver.hasLethal(attackers, defenders, op.hp, s.getBurnDamage());
+} // hasLethalAttack function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class LinearEvaluator
+ * @brief Fast static score of a position: a fixed-size feature vector dotted with tunable weights.
+ *
+ * Feature layout (stable, weight files follow it), for the evaluated player at 0-14 and the opponent at 15-29:
+ *   +0 hp, +1..+5 creature attack sum by color (white, red, green, blue, black),
+ *   +6..+10 creature hp sum by color, +11 mana still to spend (unspent pool of the active player, land count of
+ *   the waiting one), +12 cards in hand, +13 enhancement cards in play,
+ *   +14 cards left in the library;
+ * 30 is a constant 1 (bias) and 31 is 1 when the evaluated player is the one to move.
+ *
+ * The dot product uses AVX, SSE or NEON when the compiler targets them and plain C++ otherwise.
+ */
+class LinearEvaluator
+{
+public:
+    static constexpr int FeatureCount = 32;
+    static constexpr int SideFeatures = 15;
+
+    /**
+     * @brief Creates an evaluator with the built-in weights.
+     */
+    LinearEvaluator()
+    {
+        static const float side[SideFeatures] = {1.0f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.3f, 0.3f, 0.3f, 0.3f, 0.3f, 0.4f, 0.3f, 0.2f, 0.05f};
+
+        for (int i = 0; i < SideFeatures; i++)
+        {
+            weights[i] = side[i];
+            weights[SideFeatures + i] = -side[i];
+        }
+        weights[30] = 0.0f;
+        weights[31] = 0.2f;
+    }
+
+    /**
+     * @brief Loads FeatureCount whitespace separated weights from a text file.
+     *
+     * @param path Path of the weight file.
+     * @param error If not null, receives the reason when loading fails.
+     * @return False (and the old weights are kept) if the file can not be read or is too short.
+     */
+    bool loadWeights(const std::string &path, std::string *error = nullptr)
+    {
+        std::ifstream in(path);
+        float loaded[FeatureCount];
+
+        if (!in)
+        {
+            if (error)
+            {
+                *error = "weight file " + path + " could not be opened";
+            }
+            return false;
+        }
+        for (int i = 0; i < FeatureCount; i++)
+        {
+            if (!(in >> loaded[i]))
+            {
+                if (error)
+                {
+                    *error = "weight file " + path + " ends after " + std::to_string(i) + " of " + std::to_string(FeatureCount) + " weights";
+                }
+                return false;
+            }
+        }
+        std::copy(loaded, loaded + FeatureCount, weights);
+        return true;
+    }
+
+    /**
+     * @brief Writes the features of a state seen by player into out (FeatureCount floats).
+     */
+    static void extractFeatures(const GameState &s, int player, float *out)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            const PlayerState &ps = s.players[side == 0 ? player : 1 - player];
+            float *f = out + side * SideFeatures;
+            float attack[5] = {0, 0, 0, 0, 0};
+            float hp[5] = {0, 0, 0, 0, 0};
+
+            for (int c = 0; c < ps.creatureCount; c++)
+            {
+                const int color = static_cast<int>(s.prototype(ps.creatures[c].card).color);
+                if (color < 5)
+                {
+                    attack[color] += ps.creatures[c].attack;
+                    hp[color] += ps.creatures[c].hp;
+                }
+            }
+
+            f[0] = static_cast<float>(ps.hp);
+            for (int c = 0; c < 5; c++)
+            {
+                f[1 + c] = attack[c];
+                f[6 + c] = hp[c];
+            }
+            // lands are tapped for mana at the start of the turn, so the active player's untapped lands live in the pool
+            if ((side == 0 ? player : 1 - player) == s.active)
+            {
+                f[11] = static_cast<float>(ps.manaPool[0] + ps.manaPool[1] + ps.manaPool[2] + ps.manaPool[3] + ps.manaPool[4]);
+            }
+            else
+            {
+                f[11] = static_cast<float>(ps.landCount);
+            }
+            f[12] = static_cast<float>(ps.hand.size());
+            f[13] = static_cast<float>(ps.enchantmentCount);
+            f[14] = static_cast<float>(ps.libraryCount);
+        }
+        out[30] = 1.0f;
+        out[31] = s.toMove() == player ? 1.0f : 0.0f;
+    }
+
+    /**
+     * @brief Dots a feature vector with the weights.
+     */
+    float score(const float *features) const
+    {
+#if defined(__AVX__)
+        __m256 sum = _mm256_setzero_ps();
+        for (int i = 0; i < FeatureCount; i += 8)
+        {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(features + i), _mm256_load_ps(weights + i)));
+        }
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+#elif defined(__SSE__)
+        __m128 sum = _mm_setzero_ps();
+        for (int i = 0; i < FeatureCount; i += 4)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(features + i), _mm_load_ps(weights + i)));
+        }
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        return _mm_cvtss_f32(sum);
+#elif defined(__ARM_NEON)
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (int i = 0; i < FeatureCount; i += 4)
+        {
+            sum = vmlaq_f32(sum, vld1q_f32(features + i), vld1q_f32(weights + i));
+        }
+        float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+        return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+        float sum = 0.0f;
+        for (int i = 0; i < FeatureCount; i++)
+        {
+            sum += features[i] * weights[i];
+        }
+        return sum;
+#endif
+    }
+
+    /**
+     * @brief Scores a state for player.
+     */
+    float evaluate(const GameState &s, int player) const
+    {
+        alignas(32) float features[FeatureCount];
+        extractFeatures(s, player, features);
+        return score(features);
+    }
+
+    /**
+     * @brief Scores many states, each for its player to move.
+     *
+     * @param states Array of count states.
+     * @param count Number of states.
+     * @param out Receives count scores.
+     */
+    void evaluateBatch(const GameState *states, int count, float *out)
+    {
+        if (batchFeatures.size() < static_cast<std::size_t>(count) * FeatureCount)
+        {
+            batchFeatures.resize(static_cast<std::size_t>(count) * FeatureCount);
+        }
+        for (int i = 0; i < count; i++)
+        {
+            extractFeatures(states[i], states[i].toMove(), batchFeatures.data() + static_cast<std::size_t>(i) * FeatureCount);
+        }
+        for (int i = 0; i < count; i++)
+        {
+            out[i] = score(batchFeatures.data() + static_cast<std::size_t>(i) * FeatureCount);
+        }
+    }
+
+private:
+    alignas(32) float weights[FeatureCount];
+    std::vector<float> batchFeatures;
+}; // LinearEvaluator class
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class QuantizedMlp
+ * @brief A small value/policy network run on the CPU with int8 weights and 7-bit activations.
+ *
+ * The input is the LinearEvaluator feature vector, followed by one hidden ReLU layer and an output layer with the
+ * value (a win logit for the evaluated player) in row 0 and one policy logit per actionIndex() in the other rows.
+ * Weights are given as floats and quantized per row when they are loaded; the activation range of every input and
+ * hidden unit is folded into the weights, so inference is integer dot products plus one float multiply per unit.
+ *
+ * The dot products use AVX-VNNI or AVX512-VNNI (dpbusd), AVX2 (maddubs/madd) or plain C++, whichever the compiler
+ * targets. Activations are kept in 0..127 so that the AVX2 path can not saturate.
+ *
+ * Without a weight file the network reproduces the default LinearEvaluator: the first hidden units copy the features
+ * and the value row holds the linear weights. The policy rows are zero, which means uniform priors.
+ */
+class QuantizedMlp
+{
+public:
+    static constexpr int Inputs = LinearEvaluator::FeatureCount;
+    static constexpr int Hidden = 64;
+    static constexpr int Outputs = 1 + ActionCount;
+
+    /**
+     * @brief Creates the default network.
+     */
+    QuantizedMlp()
+        : inputRange(Inputs), w1(Hidden * Inputs, 0.0f), b1(Hidden, 0.0f), hiddenRange(Hidden), w2(Outputs * Hidden, 0.0f), b2(Outputs, 0.0f)
+    {
+        static const float range[LinearEvaluator::SideFeatures] = {40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 20, 10, 8, 40};
+        const LinearEvaluator linear;
+        alignas(32) float unit[Inputs];
+
+        for (int i = 0; i < Inputs; i++)
+        {
+            inputRange[i] = i < 2 * LinearEvaluator::SideFeatures ? range[i % LinearEvaluator::SideFeatures] : 1.0f;
+            w1[i * Inputs + i] = 1.0f;
+            hiddenRange[i] = inputRange[i];
+
+            std::fill(unit, unit + Inputs, 0.0f);
+            unit[i] = 1.0f;
+            w2[i] = linear.score(unit) * DefaultValueScale;
+        }
+        for (int j = Inputs; j < Hidden; j++)
+        {
+            hiddenRange[j] = 1.0f;
+        }
+        quantize();
+    }
+
+    /**
+     * @brief Loads float weights from a text file and quantizes them.
+     *
+     * The file holds whitespace separated numbers in this order: Inputs input ranges, Hidden x Inputs first layer
+     * weights (row major), Hidden first layer biases, Hidden hidden ranges, Outputs x Hidden second layer weights and
+     * Outputs second layer biases. A range is the largest value the unit is expected to take.
+     *
+     * @param path Path of the network file.
+     * @param error If not null, receives the reason when loading fails.
+     * @return False (and the old weights are kept) if the file can not be read or is too short.
+     */
+    bool loadWeights(const std::string &path, std::string *error = nullptr)
+    {
+        std::ifstream in(path);
+        std::vector<float> inR(Inputs), nw1(Hidden * Inputs), nb1(Hidden), hidR(Hidden), nw2(Outputs * Hidden), nb2(Outputs);
+
+        if (!in)
+        {
+            if (error)
+            {
+                *error = "network file " + path + " could not be opened";
+            }
+            return false;
+        }
+        for (std::vector<float> *part : {&inR, &nw1, &nb1, &hidR, &nw2, &nb2})
+        {
+            for (float &v : *part)
+            {
+                if (!(in >> v))
+                {
+                    if (error)
+                    {
+                        *error = "network file " + path + " is too short";
+                    }
+                    return false;
+                }
+            }
+        }
+        inputRange = inR;
+        w1 = nw1;
+        b1 = nb1;
+        hiddenRange = hidR;
+        w2 = nw2;
+        b2 = nb2;
+        quantize();
+        return true;
+    }
+
+    /**
+     * @brief Returns the value output (win logit) of a state for player; only the value row is computed.
+     */
+    float value(const GameState &s, int player) const
+    {
+        alignas(32) std::uint8_t input[Inputs];
+        alignas(32) std::uint8_t hidden[Hidden];
+
+        encode(s, player, input);
+        hiddenLayer(input, hidden);
+        return outputRow(hidden, 0);
+    }
+
+    /**
+     * @brief Returns the win probability of a state for player.
+     */
+    float winProbability(const GameState &s, int player) const { return 1.0f / (1.0f + std::exp(-value(s, player))); }
+
+    /**
+     * @brief Runs the full network on many states, each seen by its player to move.
+     *
+     * Every layer runs over the whole batch before the next one starts, so each weight row is used for all states
+     * while it is in cache.
+     *
+     * @param states Array of count states.
+     * @param count Number of states.
+     * @param values Receives count value logits.
+     * @param policies Receives count x ActionCount policy logits, or nullptr to compute the values only.
+     */
+    void evaluateBatch(const GameState *states, int count, float *values, float *policies)
+    {
+        batchInput.resize(static_cast<std::size_t>(count) * Inputs);
+        batchHidden.resize(static_cast<std::size_t>(count) * Hidden);
+
+        for (int b = 0; b < count; b++)
+        {
+            encode(states[b], states[b].toMove(), batchInput.data() + static_cast<std::size_t>(b) * Inputs);
+        }
+        for (int b = 0; b < count; b++)
+        {
+            hiddenLayer(batchInput.data() + static_cast<std::size_t>(b) * Inputs, batchHidden.data() + static_cast<std::size_t>(b) * Hidden);
+        }
+
+        const int rows = policies ? Outputs : 1;
+        for (int k = 0; k < rows; k++)
+        {
+            for (int b = 0; b < count; b++)
+            {
+                const float out = outputRow(batchHidden.data() + static_cast<std::size_t>(b) * Hidden, k);
+                if (k == 0)
+                {
+                    values[b] = out;
+                }
+                else
+                {
+                    policies[static_cast<std::size_t>(b) * ActionCount + k - 1] = out;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr float DefaultValueScale = 0.25f; // linear score units to win logit
+
+    // float weights as loaded, kept so the default network can be described in the same terms as a file
+    std::vector<float> inputRange, w1, b1, hiddenRange, w2, b2;
+
+    // quantized layers: int8 weights with one float scale per row
+    alignas(32) std::int8_t q1[Hidden * Inputs];
+    float scale1[Hidden];
+    alignas(32) std::int8_t q2[Outputs * Hidden];
+    float scale2[Outputs];
+    float inputStep[Inputs];
+    float hiddenStep[Hidden];
+
+    std::vector<std::uint8_t> batchInput;
+    std::vector<std::uint8_t> batchHidden;
+
+    // Quantizes one row of weights symmetrically to -127..127 after multiplying column i by step[i]
+    static float quantizeRow(const float *w, const float *step, int n, std::int8_t *out)
+    {
+        float largest = 0.0f;
+        for (int i = 0; i < n; i++)
+        {
+            largest = std::max(largest, std::fabs(w[i] * step[i]));
+        }
+
+        const float scale = largest > 0.0f ? largest / 127.0f : 1.0f;
+        for (int i = 0; i < n; i++)
+        {
+            out[i] = static_cast<std::int8_t>(std::lround(w[i] * step[i] / scale));
+        }
+        return scale;
+    }
+
+    void quantize()
+    {
+        for (int i = 0; i < Inputs; i++)
+        {
+            inputStep[i] = std::max(inputRange[i], 1e-6f) / 127.0f;
+        }
+        for (int j = 0; j < Hidden; j++)
+        {
+            hiddenStep[j] = std::max(hiddenRange[j], 1e-6f) / 127.0f;
+            scale1[j] = quantizeRow(w1.data() + j * Inputs, inputStep, Inputs, q1 + j * Inputs);
+        }
+        for (int k = 0; k < Outputs; k++)
+        {
+            scale2[k] = quantizeRow(w2.data() + k * Hidden, hiddenStep, Hidden, q2 + k * Hidden);
+        }
+    }
+
+    // Turns one activation into its 0..127 code
+    static std::uint8_t toCode(float x, float step)
+    {
+        const float code = x / step + 0.5f;
+        return static_cast<std::uint8_t>(code < 0.0f ? 0 : (code > 127.0f ? 127 : static_cast<int>(code)));
+    }
+
+    void encode(const GameState &s, int player, std::uint8_t *out) const
+    {
+        alignas(32) float features[Inputs];
+        LinearEvaluator::extractFeatures(s, player, features);
+        for (int i = 0; i < Inputs; i++)
+        {
+            out[i] = toCode(features[i], inputStep[i]);
+        }
+    }
+
+    void hiddenLayer(const std::uint8_t *input, std::uint8_t *hidden) const
+    {
+        for (int j = 0; j < Hidden; j++)
+        {
+            const float h = dot(input, q1 + j * Inputs, Inputs) * scale1[j] + b1[j];
+            hidden[j] = toCode(h, hiddenStep[j]);
+        }
+    }
+
+    float outputRow(const std::uint8_t *hidden, int k) const { return dot(hidden, q2 + k * Hidden, Hidden) * scale2[k] + b2[k]; }
+
+    // Dot product of n (a multiple of 32) unsigned activations with signed weights
+    static std::int32_t dot(const std::uint8_t *x, const std::int8_t *w, int n)
+    {
+#if defined(__AVX2__)
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < n; i += 32)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + i));
+#if defined(__AVXVNNI__)
+            sum = _mm256_dpbusd_avx_epi32(sum, a, b);
+#elif defined(__AVX512VNNI__) && defined(__AVX512VL__)
+            sum = _mm256_dpbusd_epi32(sum, a, b);
+#else
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), _mm256_set1_epi16(1)));
+#endif
+        }
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(half);
+#else
+        std::int32_t sum = 0;
+        for (int i = 0; i < n; i++)
+        {
+            sum += static_cast<std::int32_t>(x[i]) * w[i];
+        }
+        return sum;
+#endif
+    }
+}; // QuantizedMlp class
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class SearchDeadline
+ * @brief A wall-clock budget for one decision.
+ *
+ * Searches poll expired() every few nodes or after every playout, which keeps the overshoot past the deadline well
+ * under a millisecond, and then return the best move found so far.
+ */
+class SearchDeadline
+{
+public:
+    /**
+     * @brief Starts a budget of the given number of milliseconds from now.
+     */
+    explicit SearchDeadline(double milliseconds)
+        : start(std::chrono::steady_clock::now()),
+          end(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(milliseconds))) {}
+
+    /**
+     * @brief Checks whether the budget is used up.
+     */
+    bool expired() const { return std::chrono::steady_clock::now() >= end; }
+
+    /**
+     * @brief Returns the milliseconds since the budget started.
+     */
+    double elapsedMs() const { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); }
+
+private:
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+}; // SearchDeadline class
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct SearchStats
+ * @brief Latency record of one AI decision.
+ */
+struct SearchStats
+{
+    const char *decision; // which prompt of the game the decision answers
+    std::uint64_t nodes;  // search nodes for alpha-beta, playouts for MCTS
+    int depth;            // deepest completed iteration or deepest tree path
+    double elapsedMs;
+    double nodesPerSecond;
+}; // SearchStats struct
+//----------------------------------------------------------------------------------------------------------------------
+// Name the prompt of main() that the next decision of a state answers
+const char *decisionName(const GameState &s)
+{
+    switch (s.phase)
+    {
+    case Phase::Attack:
+        return "attack squad";
+    case Phase::Block:
+        return "blockers";
+    case Phase::Main1:
+    case Phase::Main2:
+        return "play card and target";
+    default:
+        return "none";
+    }
+} // decisionName function
+//----------------------------------------------------------------------------------------------------------------------
+// Build the stats record of a finished decision
+SearchStats makeSearchStats(const GameState &s, std::uint64_t nodes, int depth, const SearchDeadline &timer)
+{
+    const double elapsed = timer.elapsedMs();
+    return SearchStats{decisionName(s), nodes, depth, elapsed, elapsed > 0.0 ? nodes * 1000.0 / elapsed : 0.0};
+} // makeSearchStats function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct SolveResult
+ * @brief What the endgame solver found for a position.
+ */
+struct SolveResult
+{
+    int value;       // score for the player to move at the root
+    bool proven;     // true if value is an exact win or loss
+    int winner;      // the proven winner, or -1
+    Move bestMove;
+    int depth;       // deepest fully searched depth
+    std::uint64_t nodes;
+}; // SolveResult struct
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class EndgameSolver
+ * @brief Iterative-deepening alpha-beta search over the headless engine for positions with no hidden information.
+ *
+ * When both hands and library orders are known (late game, or when a bot is allowed to see everything) the game is
+ * deterministic, so a forced win or loss found by the search is exact. Scores are negamax values for the player to
+ * move; since one player can make several decisions in a row (attack squad, blocks) a child's score is only negated
+ * when the player to move changes.
+ *
+ * Moves are ordered by the transposition table move first and then by a history table. The transposition table is
+ * allocated once and kept between iterations and between solve() calls. The search stops at the node budget and
+ * returns the last fully searched depth. With a SearchDeadline it stops at the deadline the same way, or with the
+ * best root move of the first iteration if even that one did not finish.
+ */
+class EndgameSolver
+{
+public:
+    static constexpr int WinScore = 1000000;
+    static constexpr int MaxPly = 1024;
+
+    /**
+     * @brief Creates a solver with a transposition table of 2^ttBits entries.
+     */
+    explicit EndgameSolver(int ttBits = 20) : table(static_cast<std::size_t>(1) << ttBits), mask((static_cast<std::uint64_t>(1) << ttBits) - 1) {}
+
+    /**
+     * @brief Scores the search horizon with a linear evaluator instead of evaluateState(); nullptr restores the default.
+     */
+    void setEvaluator(const LinearEvaluator *evaluator) { this->evaluator = evaluator; }
+
+    /**
+     * @brief Searches a position until it is proven, maxDepth is reached or the node budget runs out.
+     *
+     * @param root The position to solve.
+     * @param nodeBudget Maximum number of nodes to visit.
+     * @param maxDepth Maximum number of decisions to look ahead.
+     * @param deadline Optional wall-clock budget.
+     * @return The result of the deepest completed iteration.
+     */
+    SolveResult solve(const GameState &root, std::uint64_t nodeBudget, int maxDepth = 64, const SearchDeadline *deadline = nullptr)
+    {
+        SolveResult result{leafScore(root, root.toMove()), false, -1, Move{MoveKind::Pass, 0, Move::TargetNone}, 0, 0};
+        const SearchDeadline timer(0.0);
+
+        nodes = 0;
+        budget = nodeBudget;
+        aborted = false;
+        hasPartialBest = false;
+        this->deadline = deadline;
+        for (int p = 0; p < 2; p++)
+        {
+            for (int a = 0; a < ActionCount; a++)
+            {
+                history[p][a] /= 8;
+            }
+        }
+
+        if (root.isOver())
+        {
+            result.proven = true;
+            result.winner = root.winner;
+            result.value = root.winner == root.toMove() ? WinScore : -WinScore;
+            return result;
+        }
+
+        for (int depth = 1; depth <= maxDepth; depth++)
+        {
+            const int value = search(root, depth, -WinScore - 1, WinScore + 1, 0);
+            if (aborted)
+            {
+                break;
+            }
+
+            result.value = value;
+            result.bestMove = rootBest;
+            result.depth = depth;
+            if (isMateScore(value))
+            {
+                result.proven = true;
+                result.winner = value > 0 ? root.toMove() : 1 - root.toMove();
+                break;
+            }
+        }
+
+        if (result.depth == 0 && hasPartialBest)
+        {
+            result.bestMove = partialBest;
+        }
+        result.nodes = nodes;
+        lastStats = makeSearchStats(root, nodes, result.depth, timer);
+        return result;
+    }
+
+    /**
+     * @brief Returns the latency record of the last solve() call.
+     */
+    SearchStats getLastStats() { return lastStats; }
+
+private:
+    enum Bound : std::uint8_t
+    {
+        Exact,
+        Lower,
+        Upper
+    };
+
+    struct TTEntry
+    {
+        std::uint64_t key;
+        std::int32_t value;
+        std::int16_t depth;
+        Bound bound;
+        Move best;
+    };
+
+    std::vector<TTEntry> table;
+    std::uint64_t mask;
+    std::uint64_t nodes = 0;
+    std::uint64_t budget = 0;
+    bool aborted = false;
+    const SearchDeadline *deadline = nullptr;
+    const LinearEvaluator *evaluator = nullptr;
+    Move rootBest{MoveKind::Pass, 0, Move::TargetNone};
+    Move partialBest{MoveKind::Pass, 0, Move::TargetNone};
+    bool hasPartialBest = false;
+    SearchStats lastStats{"none", 0, 0, 0.0, 0.0};
+    int history[2][ActionCount] = {};
+
+    static bool isMateScore(int v) { return v >= WinScore - MaxPly || v <= -WinScore + MaxPly; }
+
+    // Mate scores are stored relative to the node so they stay correct when reached at another ply
+    static int toTable(int v, int ply) { return v >= WinScore - MaxPly ? v + ply : (v <= -WinScore + MaxPly ? v - ply : v); }
+    static int fromTable(int v, int ply) { return v >= WinScore - MaxPly ? v - ply : (v <= -WinScore + MaxPly ? v + ply : v); }
+
+    // Static score at the horizon, in evaluateState() units (ten per hp)
+    int leafScore(const GameState &s, int player) const
+    {
+        return evaluator ? static_cast<int>(evaluator->evaluate(s, player) * 10.0f) : evaluateState(s, player);
+    }
+
+    int search(const GameState &s, int depth, int alpha, int beta, int ply)
+    {
+        if (++nodes > budget || (deadline && (nodes & 255) == 0 && deadline->expired()))
+        {
+            aborted = true;
+            return 0;
+        }
+
+        const int me = s.toMove();
+        if (s.isOver())
+        {
+            return s.winner == me ? WinScore - ply : -WinScore + ply;
+        }
+        if (depth == 0 || ply >= MaxPly)
+        {
+            return leafScore(s, me);
+        }
+
+        const std::uint64_t key = s.hash();
+        TTEntry &entry = table[key & mask];
+        Move ttMove{MoveKind::Pass, 0, Move::TargetNone};
+        bool hasTTMove = false;
+
+        if (entry.key == key)
+        {
+            ttMove = entry.best;
+            hasTTMove = true;
+            if (entry.depth >= depth && ply > 0)
+            {
+                const int v = fromTable(entry.value, ply);
+                if (entry.bound == Exact || (entry.bound == Lower && v >= beta) || (entry.bound == Upper && v <= alpha))
+                {
+                    return v;
+                }
+            }
+        }
+
+        Move moves[GameState::MaxMoves];
+        int scores[GameState::MaxMoves];
+        const int n = s.generateMoves(moves);
+
+        for (int i = 0; i < n; i++)
+        {
+            scores[i] = hasTTMove && moves[i] == ttMove ? INT32_MAX : history[me][actionIndex(moves[i])];
+        }
+
+        const int alphaOrig = alpha;
+        int best = -WinScore - 1;
+        Move bestMove = moves[0];
+
+        for (int i = 0; i < n; i++)
+        {
+            // pick the best scored remaining move
+            int pick = i;
+            for (int j = i + 1; j < n; j++)
+            {
+                if (scores[j] > scores[pick])
+                {
+                    pick = j;
+                }
+            }
+            std::swap(moves[i], moves[pick]);
+            std::swap(scores[i], scores[pick]);
+
+            GameState child = s;
+            child.applyMove(moves[i]);
+
+            int v;
+            if (child.toMove() == me && !child.isOver())
+            {
+                v = search(child, depth - 1, alpha, beta, ply + 1);
+            }
+            else
+            {
+                v = -search(child, depth - 1, -beta, -alpha, ply + 1);
+            }
+            if (child.isOver())
+            {
+                // terminal children score for the winner, not for whoever toMove() points at
+                v = child.winner == me ? WinScore - ply - 1 : -WinScore + ply + 1;
+            }
+            if (aborted)
+            {
+                return 0;
+            }
+
+            if (v > best)
+            {
+                best = v;
+                bestMove = moves[i];
+                if (ply == 0 && depth == 1)
+                {
+                    partialBest = moves[i];
+                    hasPartialBest = true;
+                }
+                if (v > alpha)
+                {
+                    alpha = v;
+                }
+                if (alpha >= beta)
+                {
+                    history[me][actionIndex(moves[i])] += depth * depth;
+                    break;
+                }
+            }
+        }
+
+        if (ply == 0)
+        {
+            rootBest = bestMove;
+        }
+
+        if (entry.key != key || depth >= entry.depth)
+        {
+            entry.key = key;
+            entry.value = toTable(best, ply);
+            entry.depth = static_cast<std::int16_t>(depth);
+            entry.bound = best <= alphaOrig ? Upper : (best >= beta ? Lower : Exact);
+            entry.best = bestMove;
+        }
+        return best;
+    }
+}; // EndgameSolver class
+//======================================================================================================================
+// Pick a move for a playout: mostly plays a card, attacks or blocks, and passes the rest of the time
+inline int playoutMoveIndex(int moveCount, std::uint64_t &rng)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    if (moveCount > 1 && (rng & 3) != 0)
+    {
+        return 1 + static_cast<int>((rng >> 2) % static_cast<std::uint64_t>(moveCount - 1));
+    }
+    return 0;
+} // playoutMoveIndex function
+//----------------------------------------------------------------------------------------------------------------------
+// Play random moves until the game ends; returns the winner, or the player ahead on evaluateState after maxSteps
+int randomPlayout(GameState &s, std::uint64_t &rng, int maxSteps = 2000)
+{
+    Move moves[GameState::MaxMoves];
+
+    for (int step = 0; step < maxSteps && !s.isOver(); step++)
+    {
+        const int n = s.generateMoves(moves);
+        s.applyMove(moves[playoutMoveIndex(n, rng)]);
+    }
+
+    if (s.isOver())
+    {
+        return s.winner;
+    }
+    return evaluateState(s, 0) >= 0 ? 0 : 1;
+} // randomPlayout function
+//======================================================================================================================
+/**
+ * @class Determinizer
+ * @brief Samples full game states that agree with everything one player can see.
+ *
+ * The observer knows both deck lists (the library1 / library2 construction in main()), their own hand, every card in
+ * play, both discard piles and the size of the opponent's hand. The cards that are left are dealt at random into the
+ * opponent's hand and both libraries; the order of the observer's own library is hidden as well.
+ *
+ * The unseen cards are worked out once in the constructor, so sample() only copies the state and shuffles fixed-size
+ * arrays and never allocates.
+ */
+class Determinizer
+{
+public:
+    /**
+     * @brief Prepares the unseen card pools of a position.
+     *
+     * @param observed The real state; only the parts visible to observer are used.
+     * @param observer The player the samples are for.
+     * @param deck1 Deck list of player 1.
+     * @param size1 Number of cards in deck1.
+     * @param deck2 Deck list of player 2.
+     * @param size2 Number of cards in deck2.
+     */
+    Determinizer(const GameState &observed, int observer, const CardId *deck1, int size1, const CardId *deck2, int size2)
+        : base(observed), observer(observer)
+    {
+        const CardId *decks[2] = {deck1, deck2};
+        const int sizes[2] = {size1, size2};
+
+        for (int p = 0; p < 2; p++)
+        {
+            const PlayerState &ps = observed.players[p];
+
+            unseenCount[p] = 0;
+            for (int i = 0; i < sizes[p] && unseenCount[p] < PlayerState::MaxLibrary; i++)
+            {
+                unseen[p][unseenCount[p]++] = decks[p][i];
+            }
+
+            // everything public, plus the observer's own hand, is taken out of the deck list
+            for (int i = 0; i < ps.landCount; i++)
+            {
+                takeOut(p, ps.lands[i]);
+            }
+            for (int i = 0; i < ps.creatureCount; i++)
+            {
+                takeOut(p, ps.creatures[i].card);
+            }
+            for (int i = 0; i < ps.enchantmentCount; i++)
+            {
+                takeOut(p, ps.enchantments[i]);
+            }
+            for (int i = 0; i < ps.discardCount; i++)
+            {
+                takeOut(p, ps.discard[i]);
+            }
+            if (p == observer)
+            {
+                for (int i = 0; i < ps.hand.size(); i++)
+                {
+                    takeOut(p, ps.hand[i]);
+                }
+            }
+
+            // if the deck list does not match the state, keep the real hidden cards so sizes stay right
+            const int hidden = ps.libraryCount + (p == observer ? 0 : ps.hand.size());
+            if (unseenCount[p] != hidden)
+            {
+                unseenCount[p] = 0;
+                for (int i = 0; i < ps.libraryCount; i++)
+                {
+                    unseen[p][unseenCount[p]++] = ps.library[i];
+                }
+                for (int i = 0; p != observer && i < ps.hand.size(); i++)
+                {
+                    unseen[p][unseenCount[p]++] = ps.hand[i];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Writes one random state consistent with the observer's information.
+     *
+     * @param out Receives the sampled state.
+     * @param rng State of the caller's random generator.
+     */
+    void sample(GameState &out, std::uint64_t &rng) const
+    {
+        out = base;
+
+        for (int p = 0; p < 2; p++)
+        {
+            CardId cards[PlayerState::MaxLibrary];
+            const int n = unseenCount[p];
+
+            for (int i = 0; i < n; i++)
+            {
+                cards[i] = unseen[p][i];
+            }
+            for (int i = n - 1; i > 0; i--)
+            {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                std::swap(cards[i], cards[rng % static_cast<std::uint64_t>(i + 1)]);
+            }
+
+            PlayerState &ps = out.players[p];
+            int next = 0;
+            if (p != observer)
+            {
+                for (int i = 0; i < ps.hand.size(); i++)
+                {
+                    ps.hand[i] = cards[next++];
+                }
+            }
+            for (int i = 0; i < ps.libraryCount; i++)
+            {
+                ps.library[i] = cards[next++];
+            }
+        }
+        out.rebuildZoneHashes(); // hidden cards may have moved between hand and library
+    }
+
+private:
+    GameState base;
+    int observer;
+    int unseenCount[2];
+    CardId unseen[2][PlayerState::MaxLibrary];
+
+    void takeOut(int p, CardId card)
+    {
+        for (int i = 0; i < unseenCount[p]; i++)
+        {
+            if (unseen[p][i] == card)
+            {
+                unseen[p][i] = unseen[p][--unseenCount[p]];
+                return;
+            }
+        }
+    }
+}; // Determinizer class
+//======================================================================================================================
+/**
+ * @class Arena
+ * @brief Bump allocator that owns every object of one search and frees them all with a single reset().
+ *
+ * Memory is handed out from large blocks by moving an offset forward. reset() only rewinds the offset, so the blocks
+ * are kept and the next decision reuses them without calling malloc again. Objects are never destroyed one by one,
+ * so only trivially destructible types can be created in an arena. An arena is not thread safe; give each search
+ * thread its own.
+ */
+class Arena
+{
+public:
+    /**
+     * @brief Creates an empty arena that grows in blocks of blockSize bytes.
+     */
+    explicit Arena(std::size_t blockSize = 1 << 20) : blockSize(blockSize) {}
+
+    /**
+     * @brief Returns size bytes aligned to align, valid until the next reset().
+     */
+    void *allocate(std::size_t size, std::size_t align)
+    {
+        while (current < blocks.size())
+        {
+            const std::size_t start = (offset + align - 1) & ~(align - 1);
+            if (start + size <= blocks[current].size)
+            {
+                offset = start + size;
+                used += size;
+                return blocks[current].data.get() + start;
+            }
+            current++;
+            offset = 0;
+        }
+
+        // no kept block is big enough, add one
+        const std::size_t size2 = size + align > blockSize ? size + align : blockSize;
+        blocks.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[size2]), size2});
+        current = blocks.size() - 1;
+        offset = 0;
+        return allocate(size, align);
+    }
+
+    /**
+     * @brief Constructs a T in the arena.
+     */
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+    }
+
+    /**
+     * @brief Frees everything allocated so far at once and keeps the blocks for reuse.
+     */
+    void reset()
+    {
+        current = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    /**
+     * @brief Returns the bytes handed out since the last reset().
+     */
+    std::size_t getUsed() const { return used; }
+
+    /**
+     * @brief Returns the bytes owned by the arena.
+     */
+    std::size_t getCapacity() const
+    {
+        std::size_t total = 0;
+        for (const Block &b : blocks)
+        {
+            total += b.size;
+        }
+        return total;
+    }
+
+private:
+    struct Block
+    {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+
+    std::size_t blockSize;
+    std::vector<Block> blocks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+    std::size_t used = 0;
+}; // Arena class
+//======================================================================================================================
+/**
+ * @class WorkerPool
+ * @brief Threads that are started once and then run one parallel task after another.
+ *
+ * run() hands the task to every worker, the calling thread being worker 0, and returns when all of them are done, so
+ * every call is a full barrier. Code with a short parallel phase per step or per decision pays a wake-up for it
+ * instead of creating and joining threads. The task is reached through a plain function pointer, so run() never
+ * allocates. One thread at a time may call run().
+ */
+class WorkerPool
+{
+public:
+    /**
+     * @brief Starts workerCount - 1 threads; the caller of run() is the last worker.
+     *
+     * @param workerCount Number of workers, 0 for one per hardware thread.
+     */
+    explicit WorkerPool(int workerCount = 0)
+    {
+        if (workerCount <= 0)
+        {
+            workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        for (int w = 1; w < workerCount; w++)
+        {
+            threads.emplace_back(&WorkerPool::loop, this, w);
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            generation++;
+        }
+        start.notify_all();
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Returns the number of workers, the calling thread included.
+     */
+    int size() const { return static_cast<int>(threads.size()) + 1; }
+
+    /**
+     * @brief Calls task(worker) once for every worker index in [0, size()) and waits until all calls have returned.
+     */
+    template <typename F>
+    void run(F &&task)
+    {
+        using Task = std::remove_reference_t<F>;
+
+        if (!threads.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                call = [](void *context, int worker)
+                { (*static_cast<Task *>(context))(worker); };
+                context = const_cast<void *>(static_cast<const void *>(&task));
+                busy = static_cast<int>(threads.size());
+                generation++;
+            }
+            start.notify_all();
+        }
+
+        task(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]()
+                      { return busy == 0; });
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start;    // a new task or stopping
+    std::condition_variable finished; // the last worker is done
+    std::uint64_t generation = 0;     // tasks handed out so far
+    void (*call)(void *, int) = nullptr;
+    void *context = nullptr;
+    int busy = 0; // workers still running the current task
+    bool stopping = false;
+
+    void loop(int worker)
+    {
+        std::uint64_t seen = 0;
+
+        for (;;)
+        {
+            void (*task)(void *, int);
+            void *taskContext;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [this, seen]()
+                           { return generation != seen; });
+                seen = generation;
+                if (stopping)
+                {
+                    return;
+                }
+                task = call;
+                taskContext = context;
+            }
+
+            task(taskContext, worker);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0)
+            {
+                finished.notify_one();
+            }
+        }
+    }
+}; // WorkerPool class
+//======================================================================================================================
+/**
+ * @class IsmctsPlayer
+ * @brief Information-set Monte Carlo tree search player that never looks at hidden cards.
+ *
+ * Every iteration samples a determinization from a Determinizer, walks the tree using only the moves that are legal
+ * in that sample (UCB with availability counts), expands one untried move, finishes the game with a random playout
+ * and backs the result up. Each node keeps the reward of the player who made its move.
+ *
+ * Tree edges are keyed by moveKey(), not by actionIndex(): a card play is identified by the card and its target
+ * instead of the hand slot, because the opponent's hand is resampled every iteration and the same slot holds a
+ * different card in each determinization. A child found by its key is played with the move of the current sample.
+ *
+ * The search runs on several threads at once. Every thread grows its own tree from its own samples and the root
+ * statistics of all threads are added up to pick the move (root parallelization), so threads never wait on each
+ * other. Each thread's tree lives in its own Arena, which is reset between decisions and keeps its memory.
+ *
+ * Statistics below the root are not shared between threads, on purpose. Unlike the tree of ParallelMcts, where
+ * every thread walks the same game, here every iteration sees its own legal moves: the availability count of every
+ * child legal in the sample changes on each walk, and expansion adds children keyed by cards that only some samples
+ * hold. A shared tree would need atomics on every availability and reward and a lock on every child list, all hit by
+ * every thread on every level. Separate trees also draw separate determinizations, and summing the roots averages
+ * over more hidden hands than one tree of the same iteration count visits, which is where most of the error of a
+ * determinized search comes from.
+ */
+class IsmctsPlayer
+{
+public:
+    /**
+     * @brief Creates a player.
+     *
+     * @param threadCount Number of search threads, 0 for one per hardware thread.
+     * @param exploration UCB exploration constant.
+     */
+    explicit IsmctsPlayer(int threadCount = 0, double exploration = 0.7) : exploration(exploration), workers(threadCount), trees(workers.size()) {}
+
+    /**
+     * @brief Chooses a move for the player to move in state, using only what that player can see.
+     *
+     * @param state The real game state.
+     * @param iterations Number of iterations per thread.
+     * @param deck1 Deck list of player 1, nullptr for the decks of the active card table.
+     * @param size1 Number of cards in deck1.
+     * @param deck2 Deck list of player 2.
+     * @param size2 Number of cards in deck2.
+     * @return The chosen move.
+     */
+    Move chooseMove(const GameState &state, int iterations, const CardId *deck1 = nullptr, int size1 = 0, const CardId *deck2 = nullptr, int size2 = 0)
+    {
+        return search(state, iterations, nullptr, deck1, size1, deck2, size2);
+    }
+
+    /**
+     * @brief Chooses a move like chooseMove() above, searching until the deadline instead of for a fixed count.
+     */
+    Move chooseMove(const GameState &state, const SearchDeadline &deadline, const CardId *deck1 = nullptr, int size1 = 0, const CardId *deck2 = nullptr,
+                    int size2 = 0)
+    {
+        return search(state, INT_MAX, &deadline, deck1, size1, deck2, size2);
+    }
+
+    /**
+     * @brief Returns the latency record of the last decision.
+     */
+    SearchStats getLastStats() { return lastStats; }
+
+private:
+    struct Node
+    {
+        Move move;
+        int key;    // moveKey() of move
+        int player; // the player who made move
+        Node *parent;
+        Node *firstChild;
+        Node *nextSibling;
+        int visits;
+        int availability;
+        double reward;
+    };
+
+    // Play keys of every card and target slot follow the action indices
+    static int keyCount(const CardTable &table) { return ActionCount + table.cardCount * TargetSlots; }
+
+    struct Tree
+    {
+        Arena arena;
+        Node *root;
+        std::vector<int> legalStamp; // keyCount() entries for the pool of the searched game
+        std::vector<int> legalMove;  // index of the key's move in the current sample's move list
+        std::vector<int> childStamp;
+        int stamp;
+        int iterations;
+        int maxDepth;
+    };
+
+    double exploration;
+    WorkerPool workers;
+    std::vector<Tree> trees; // one per worker
+    std::uint64_t seedCounter = 1;
+    SearchStats lastStats{"none", 0, 0, 0.0, 0.0};
+
+    // Key of a move in the tree: the action index, except that a card play is keyed by the card id and target slot
+    static int moveKey(const GameState &s, const Move &m)
+    {
+        if (m.kind != MoveKind::PlayCard)
+        {
+            return actionIndex(m);
+        }
+        return ActionCount + s.players[s.active].hand[m.slot] * TargetSlots + (actionIndex(m) - 1) % TargetSlots;
+    }
+
+    Move search(const GameState &state, int iterations, const SearchDeadline *deadline, const CardId *deck1, int size1, const CardId *deck2, int size2)
+    {
+        const SearchDeadline timer(0.0);
+        Move moves[GameState::MaxMoves];
+        const int n = state.generateMoves(moves);
+        if (n <= 1)
+        {
+            lastStats = makeSearchStats(state, 0, 0, timer);
+            return moves[0];
+        }
+
+        const CardTable &t = state.getCardTable();
+        const Determinizer determinizer(state, state.toMove(), deck1 ? deck1 : t.decks[0], deck1 ? size1 : t.deckSizes[0], deck2 ? deck2 : t.decks[1],
+                                        deck2 ? size2 : t.deckSizes[1]);
+        const int keyTotal = keyCount(t);
+        workers.run([this, iterations, deadline, &determinizer, keyTotal](int t)
+                    { runTree(trees[t], determinizer, keyTotal, iterations, deadline, 0x853c49e6748fea9bull * (t + 1) ^ seedCounter); });
+        seedCounter++;
+
+        // add up the root children of every tree by key
+        int bestVisits = -1;
+        Move best = moves[0];
+        for (int i = 0; i < n; i++)
+        {
+            const int key = moveKey(state, moves[i]);
+            int visits = 0;
+
+            for (const Tree &tree : trees)
+            {
+                for (const Node *c = tree.root->firstChild; c; c = c->nextSibling)
+                {
+                    if (c->key == key)
+                    {
+                        visits += c->visits;
+                    }
+                }
+            }
+            if (visits > bestVisits)
+            {
+                bestVisits = visits;
+                best = moves[i];
+            }
+        }
+
+        std::uint64_t playouts = 0;
+        int depth = 0;
+        for (const Tree &tree : trees)
+        {
+            playouts += static_cast<std::uint64_t>(tree.iterations);
+            depth = tree.maxDepth > depth ? tree.maxDepth : depth;
+        }
+        lastStats = makeSearchStats(state, playouts, depth, timer);
+        return best;
+    }
+
+    void runTree(Tree &tree, const Determinizer &determinizer, int keyTotal, int iterations, const SearchDeadline *deadline, std::uint64_t rng)
+    {
+        tree.arena.reset();
+        tree.root = tree.arena.create<Node>(Move{MoveKind::Pass, 0, Move::TargetNone}, 0, -1, nullptr, nullptr, nullptr, 0, 0, 0.0);
+        tree.legalStamp.assign(static_cast<std::size_t>(keyTotal), 0); // allocates only when the pool grows
+        tree.legalMove.resize(static_cast<std::size_t>(keyTotal));
+        tree.childStamp.assign(static_cast<std::size_t>(keyTotal), 0);
+        tree.stamp = 0;
+        tree.iterations = 0;
+        tree.maxDepth = 0;
+
+        Move moves[GameState::MaxMoves];
+        int keys[GameState::MaxMoves];
+        GameState s;
+
+        for (int it = 0; it < iterations; it++)
+        {
+            if (deadline && deadline->expired())
+            {
+                break;
+            }
+            tree.iterations++;
+
+            determinizer.sample(s, rng);
+            Node *node = tree.root;
+            int depth = 0;
+
+            // selection and expansion
+            while (!s.isOver())
+            {
+                const int n = s.generateMoves(moves);
+                const int stamp = ++tree.stamp;
+
+                for (int i = 0; i < n; i++)
+                {
+                    keys[i] = moveKey(s, moves[i]);
+                    tree.legalStamp[keys[i]] = stamp;
+                    tree.legalMove[keys[i]] = i;
+                }
+
+                Node *bestChild = nullptr;
+                double bestScore = -1.0;
+                for (Node *c = node->firstChild; c; c = c->nextSibling)
+                {
+                    Node &child = *c;
+                    if (tree.legalStamp[child.key] != stamp)
+                    {
+                        continue;
+                    }
+                    tree.childStamp[child.key] = stamp;
+                    child.availability++;
+
+                    const double score = child.reward / child.visits + exploration * std::sqrt(std::log(static_cast<double>(child.availability)) / child.visits);
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestChild = c;
+                    }
+                }
+
+                // expand the first legal move that has no child yet
+                int untried = -1;
+                for (int i = 0; i < n; i++)
+                {
+                    if (tree.childStamp[keys[i]] != stamp)
+                    {
+                        untried = i;
+                        break;
+                    }
+                }
+
+                if (untried >= 0)
+                {
+                    Node *child = tree.arena.create<Node>(moves[untried], keys[untried], s.toMove(), node, nullptr, node->firstChild, 0, 1, 0.0);
+                    node->firstChild = child;
+                    s.applyMove(moves[untried]);
+                    node = child;
+                    break;
+                }
+
+                // the child may have been created in a sample where its card sat in another hand slot
+                s.applyMove(moves[tree.legalMove[bestChild->key]]);
+                node = bestChild;
+                depth++;
+            }
+            tree.maxDepth = depth + 1 > tree.maxDepth ? depth + 1 : tree.maxDepth;
+
+            const int winner = randomPlayout(s, rng);
+
+            for (; node; node = node->parent)
+            {
+                node->visits++;
+                if (node->player == winner)
+                {
+                    node->reward += 1.0;
+                }
+            }
+        }
+    }
+}; // IsmctsPlayer class
+//======================================================================================================================
+/**
+ * @class ParallelMcts
+ * @brief Monte Carlo tree search where many threads grow one shared tree for the same decision.
+ *
+ * Nodes live in a pool that is allocated once; a thread that expands a node reserves one block of children with a
+ * single atomic add, fills it in and publishes it with a release store, so no thread ever locks or calls new while
+ * searching. Visit, win and virtual loss counters are atomics. A thread walking down a branch adds a virtual loss to
+ * every node on its path, which makes that branch look worse to the other threads until the playout result is backed
+ * up, so the threads spread over different branches instead of all following the same one.
+ *
+ * The search threads are a WorkerPool started with the search, so a decision wakes them instead of creating them.
+ *
+ * The search sees the whole state it is given. To keep hidden cards hidden, give it a sample from a Determinizer.
+ * With a QuantizedMlp set, new leaves are scored by the network's win probability instead of a random playout.
+ */
+class ParallelMcts
+{
+public:
+    /**
+     * @brief Creates the search and its node pool.
+     *
+     * @param threadCount Number of search threads, 0 for one per hardware thread.
+     * @param poolCapacity Number of nodes in the pool; when it is full the tree stops growing.
+     * @param exploration UCT exploration constant.
+     * @param virtualLoss Losses added to a node while a thread is working below it.
+     */
+    explicit ParallelMcts(int threadCount = 0, std::size_t poolCapacity = 1 << 20, double exploration = 0.7, int virtualLoss = 3)
+        : workers(threadCount), capacity(poolCapacity), exploration(exploration), virtualLoss(virtualLoss), pool(new Node[poolCapacity])
+    {
+    }
+
+    /**
+     * @brief Searches the state and returns the most visited move of the player to move.
+     *
+     * @param state The position to search.
+     * @param iterations Total number of playouts, shared by all threads.
+     * @param deadline Optional wall-clock budget; the search stops at whichever limit comes first.
+     * @return The chosen move.
+     */
+    Move chooseMove(const GameState &state, int iterations, const SearchDeadline *deadline = nullptr)
+    {
+        const SearchDeadline timer(0.0);
+        this->deadline = deadline;
+        playouts.store(0, std::memory_order_relaxed);
+        maxDepth.store(0, std::memory_order_relaxed);
+        next.store(0, std::memory_order_relaxed);
+        remaining.store(iterations, std::memory_order_relaxed);
+
+        const int root = allocate(1);
+        initNode(root, Move{MoveKind::Pass, 0, Move::TargetNone}, -1);
+        rootState = state;
+        expand(root, state);
+
+        workers.run([this](int t)
+                    { runWorker(0x9e3779b97f4a7c15ull * (t + 1) ^ seedCounter); });
+        seedCounter++;
+
+        const Node &r = pool[root];
+        int best = r.firstChild;
+        for (int c = r.firstChild; c < r.firstChild + r.childCount; c++)
+        {
+            if (pool[c].visits.load(std::memory_order_relaxed) > pool[best].visits.load(std::memory_order_relaxed))
+            {
+                best = c;
+            }
+        }
+        lastStats = makeSearchStats(state, playouts.load(std::memory_order_relaxed), maxDepth.load(std::memory_order_relaxed), timer);
+        return best >= 0 ? pool[best].move : Move{MoveKind::Pass, 0, Move::TargetNone};
+    }
+
+    /**
+     * @brief Returns the latency record of the last decision.
+     */
+    SearchStats getLastStats() { return lastStats; }
+
+    /**
+     * @brief Returns the number of nodes used by the last search.
+     */
+    std::size_t getNodesUsed() { return next.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Writes the visit share of every root move of the last search, indexed by actionIndex().
+     *
+     * @param policy Buffer of ActionCount values; moves that were not searched get 0.
+     */
+    void getRootPolicy(float *policy)
+    {
+        const Node &r = pool[0]; // chooseMove() always allocates the root first
+        int total = 0;
+
+        std::fill(policy, policy + ActionCount, 0.0f);
+        for (int c = r.firstChild; c >= 0 && c < r.firstChild + r.childCount; c++)
+        {
+            total += pool[c].visits.load(std::memory_order_relaxed);
+        }
+        for (int c = r.firstChild; total > 0 && c < r.firstChild + r.childCount; c++)
+        {
+            policy[actionIndex(pool[c].move)] = static_cast<float>(pool[c].visits.load(std::memory_order_relaxed)) / total;
+        }
+    }
+
+    /**
+     * @brief Scores leaves with a value network instead of random playouts; nullptr restores the playouts.
+     */
+    void setNetwork(const QuantizedMlp *network) { this->network = network; }
+
+private:
+    enum : int
+    {
+        Leaf,
+        Expanding,
+        Expanded
+    };
+
+    struct Node
+    {
+        Move move;
+        int player; // the player who made move
+        int firstChild;
+        int childCount;
+        std::atomic<int> visits;
+        std::atomic<std::int64_t> wins; // in 1 / WinUnit of a win, so network values can count as part of a win
+        std::atomic<int> pending; // virtual losses of threads below this node
+        std::atomic<int> expansion;
+    };
+
+    static constexpr int MaxPath = 4096;
+    static constexpr int WinUnit = 1024;
+
+    WorkerPool workers;
+    std::size_t capacity;
+    double exploration;
+    int virtualLoss;
+    std::unique_ptr<Node[]> pool;
+    std::atomic<std::size_t> next{0};
+    std::atomic<int> remaining{0};
+    std::atomic<std::uint64_t> playouts{0};
+    std::atomic<int> maxDepth{0};
+    const SearchDeadline *deadline = nullptr;
+    const QuantizedMlp *network = nullptr;
+    SearchStats lastStats{"none", 0, 0, 0.0, 0.0};
+    GameState rootState;
+    std::uint64_t seedCounter = 1;
+
+    // Reserve count consecutive nodes, or -1 when the pool is full; next never passes the capacity, so it is the
+    // number of nodes in use
+    int allocate(int count)
+    {
+        std::size_t first = next.load(std::memory_order_relaxed);
+        do
+        {
+            if (first + static_cast<std::size_t>(count) > capacity)
+            {
+                return -1;
+            }
+        } while (!next.compare_exchange_weak(first, first + static_cast<std::size_t>(count), std::memory_order_relaxed));
+        return static_cast<int>(first);
+    }
+
+    void initNode(int index, const Move &move, int player)
+    {
+        Node &n = pool[index];
+        n.move = move;
+        n.player = player;
+        n.firstChild = -1;
+        n.childCount = 0;
+        n.visits.store(0, std::memory_order_relaxed);
+        n.wins.store(0, std::memory_order_relaxed);
+        n.pending.store(0, std::memory_order_relaxed);
+        n.expansion.store(Leaf, std::memory_order_relaxed);
+    }
+
+    // Create the children of a node; only the thread that won the Leaf -> Expanding exchange calls this
+    bool expand(int index, const GameState &s)
+    {
+        Move moves[GameState::MaxMoves];
+        const int n = s.generateMoves(moves);
+        const int first = n > 0 ? allocate(n) : -1;
+
+        if (first < 0)
+        {
+            pool[index].expansion.store(Leaf, std::memory_order_release);
+            return false;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            initNode(first + i, moves[i], s.toMove());
+        }
+        pool[index].firstChild = first;
+        pool[index].childCount = n;
+        pool[index].expansion.store(Expanded, std::memory_order_release);
+        return true;
+    }
+
+    int selectChild(int index)
+    {
+        const Node &parent = pool[index];
+        const double parentVisits = parent.visits.load(std::memory_order_relaxed) + parent.pending.load(std::memory_order_relaxed) + 1.0;
+        const double logParent = std::log(parentVisits);
+        int best = parent.firstChild;
+        double bestScore = -1.0;
+
+        for (int c = parent.firstChild; c < parent.firstChild + parent.childCount; c++)
+        {
+            const Node &child = pool[c];
+            const int visits = child.visits.load(std::memory_order_relaxed);
+            const int pending = child.pending.load(std::memory_order_relaxed);
+            if (visits + pending == 0)
+            {
+                return c;
+            }
+
+            const double n = visits + pending;
+            const double score = static_cast<double>(child.wins.load(std::memory_order_relaxed)) / WinUnit / n + exploration * std::sqrt(logParent / n);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best = c;
+            }
+        }
+        return best;
+    }
+
+    void runWorker(std::uint64_t rng)
+    {
+        int path[MaxPath];
+
+        while (remaining.fetch_sub(1, std::memory_order_relaxed) > 0 && !(deadline && deadline->expired()))
+        {
+            GameState s = rootState;
+            int depth = 0;
+            int node = 0;
+            path[depth++] = node;
+
+            while (!s.isOver() && depth < MaxPath)
+            {
+                int state = pool[node].expansion.load(std::memory_order_acquire);
+                if (state == Leaf)
+                {
+                    int expected = Leaf;
+                    if (!pool[node].expansion.compare_exchange_strong(expected, Expanding, std::memory_order_acq_rel) || !expand(node, s))
+                    {
+                        break; // another thread is expanding it, or the pool is full: play out from here
+                    }
+                    state = Expanded;
+                }
+                if (state != Expanded)
+                {
+                    break;
+                }
+
+                node = selectChild(node);
+                pool[node].pending.fetch_add(virtualLoss, std::memory_order_relaxed);
+                s.applyMove(pool[node].move);
+                path[depth++] = node;
+
+                if (pool[node].visits.load(std::memory_order_relaxed) == 0)
+                {
+                    break; // first visit of this node, play out from it
+                }
+            }
+
+            // share of a win for player 0; the network sees the leaf from the side to move
+            int share0;
+            if (network && !s.isOver())
+            {
+                const int p = static_cast<int>(network->winProbability(s, s.toMove()) * WinUnit + 0.5f);
+                share0 = s.toMove() == 0 ? p : WinUnit - p;
+            }
+            else
+            {
+                share0 = randomPlayout(s, rng) == 0 ? WinUnit : 0;
+            }
+            playouts.fetch_add(1, std::memory_order_relaxed);
+            int deepest = maxDepth.load(std::memory_order_relaxed);
+            while (depth > deepest && !maxDepth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed))
+            {
+            }
+
+            for (int i = depth - 1; i >= 0; i--)
+            {
+                Node &n = pool[path[i]];
+                n.visits.fetch_add(1, std::memory_order_relaxed);
+                if (n.player >= 0)
+                {
+                    n.wins.fetch_add(n.player == 0 ? share0 : WinUnit - share0, std::memory_order_relaxed);
+                }
+                if (i > 0)
+                {
+                    n.pending.fetch_sub(virtualLoss, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}; // ParallelMcts class
+//======================================================================================================================
+// Binary encoding of a GameState; see serializeState() for the layout
+constexpr std::uint8_t StateFormatVersion = 4;
+constexpr int MaxSerializedStateBytes = 33 + 2 * PlayerState::MaxLibrary * 2 + 2 * PlayerState::MaxCreatures * 4 + 5 + PlayerState::MaxCreatures + 16;
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Writes the full state of a game in the compact binary format.
+ *
+ * Layout, all multi-byte integers little-endian:
+ *   version; flags (bit 0 active player, bits 1-3 phase, bits 4-5 land played by player 0 / 1, bits 6-7 winner + 1);
+ *   uint16 turn; the rules as five bytes in GameRules order; then for both players: int8 hp, five mana pool bytes, the six zone sizes (library, hand, lands,
+ *   creatures, enhancements, discard) and a uint16 card id per card in those zones in that order, library bottom
+ *   first. Every creature adds a byte of flags (bit 0 first strike, 1 trample, 2 tapped, 3 stats differ from the
+ *   printed card) and, when bit 3 is set, int8 attack, hp left and toughness. Then uint16 attack squad; when it is
+ *   not empty, uint16 used blockers, int8 block cursor and one int8 blocker per attacker. Last the uint64 rng state
+ *   and the uint64 turn hash chain.
+ *
+ * Games of the built-in decks stay under 200 bytes in practice. MaxSerializedStateBytes covers full libraries of
+ * PlayerState::MaxLibrary cards. It comes to 358 bytes, because the worst case also has 16 creatures with changed
+ * stats on both sides in the middle of a block.
+ *
+ * @param s The state to encode.
+ * @param out Buffer of at least MaxSerializedStateBytes bytes.
+ * @return The number of bytes written.
+ */
+int serializeState(const GameState &s, std::uint8_t *out)
+{
+    std::uint8_t *p = out;
+    auto put16 = [&p](unsigned v)
+    {
+        *p++ = static_cast<std::uint8_t>(v & 0xff);
+        *p++ = static_cast<std::uint8_t>(v >> 8);
+    };
+    // the count is passed by value so it is not reloaded after every byte store
+    auto putCards = [&p](const CardId *zone, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            p[2 * i] = static_cast<std::uint8_t>(zone[i] & 0xff);
+            p[2 * i + 1] = static_cast<std::uint8_t>(zone[i] >> 8);
+        }
+        p += 2 * count;
+    };
+
+    *p++ = StateFormatVersion;
+    *p++ = static_cast<std::uint8_t>(s.active | static_cast<int>(s.phase) << 1 | s.players[0].landPlayed << 4 | s.players[1].landPlayed << 5 | (s.winner + 1) << 6);
+    put16(static_cast<unsigned>(s.turn));
+    *p++ = static_cast<std::uint8_t>(s.rules.startingHp);
+    *p++ = static_cast<std::uint8_t>(s.rules.handLimit);
+    *p++ = static_cast<std::uint8_t>(s.rules.openingHand);
+    *p++ = static_cast<std::uint8_t>(s.rules.deckSize);
+    *p++ = static_cast<std::uint8_t>(s.rules.attackSquadSize);
+
+    for (const PlayerState &ps : s.players)
+    {
+        *p++ = static_cast<std::uint8_t>(ps.hp);
+        for (int c = 0; c < 5; c++)
+        {
+            *p++ = static_cast<std::uint8_t>(ps.manaPool[c]);
+        }
+        *p++ = static_cast<std::uint8_t>(ps.libraryCount);
+        *p++ = static_cast<std::uint8_t>(ps.hand.size());
+        *p++ = static_cast<std::uint8_t>(ps.landCount);
+        *p++ = static_cast<std::uint8_t>(ps.creatureCount);
+        *p++ = static_cast<std::uint8_t>(ps.enchantmentCount);
+        *p++ = static_cast<std::uint8_t>(ps.discardCount);
+
+        putCards(ps.library, ps.libraryCount);
+        putCards(ps.hand.data(), ps.hand.size());
+        putCards(ps.lands, ps.landCount);
+        for (int i = 0; i < ps.creatureCount; i++)
+        {
+            const CreatureSlot &c = ps.creatures[i];
+            const CardPrototype &proto = s.prototype(c.card);
+            const bool modified = c.attack != proto.attack || c.hp != proto.hp || c.toughness != proto.hp;
+
+            put16(c.card);
+            *p++ = static_cast<std::uint8_t>(c.firstStrike | c.trample << 1 | c.tapped << 2 | modified << 3);
+            if (modified)
+            {
+                *p++ = static_cast<std::uint8_t>(c.attack);
+                *p++ = static_cast<std::uint8_t>(c.hp);
+                *p++ = static_cast<std::uint8_t>(c.toughness);
+            }
+        }
+        putCards(ps.enchantments, ps.enchantmentCount);
+        putCards(ps.discard, ps.discardCount);
+    }
+
+    put16(s.attackers);
+    if (s.attackers != 0)
+    {
+        put16(s.usedBlockers);
+        *p++ = static_cast<std::uint8_t>(s.blockCursor);
+        for (int a = 0; a < PlayerState::MaxCreatures; a++)
+        {
+            if (s.attackers & (1u << a))
+            {
+                *p++ = static_cast<std::uint8_t>(s.blockers[a]);
+            }
+        }
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        *p++ = static_cast<std::uint8_t>(s.rng >> (8 * i));
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        *p++ = static_cast<std::uint8_t>(s.turnHash >> (8 * i));
+    }
+    return static_cast<int>(p - out);
+} // serializeState function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Reads a state written by serializeState().
+ *
+ * The input is checked against the buffer size, the engine's zone limits and the rules it carries. Every attacker,
+ * blocker and block cursor must point at an existing creature and fit the phase, and the squad must fit the rules'
+ * attackSquadSize. A truncated or corrupt buffer is
+ * rejected rather than read past its end, and an accepted state can be played on without indexing outside a zone.
+ *
+ * @param in The encoded bytes.
+ * @param size Number of bytes available.
+ * @param s Receives the state; unused slots are zeroed and the zone hashes are rebuilt.
+ * @param table Card pool the state is played with; its card ids are checked against it.
+ * @return The number of bytes read, or 0 if the buffer is not a valid state.
+ */
+int deserializeState(const std::uint8_t *in, std::size_t size, GameState &s, const CardTable &table = getActiveCardTable())
+{
+    const std::uint8_t *p = in;
+    const std::uint8_t *end = in + size;
+    auto has = [&p, end](std::size_t n)
+    { return static_cast<std::size_t>(end - p) >= n; };
+    auto get16 = [&p]()
+    {
+        const unsigned v = p[0] | p[1] << 8;
+        p += 2;
+        return v;
+    };
+    auto readCards = [&p, &has, &table](CardId *zone, int count)
+    {
+        if (!has(2 * static_cast<std::size_t>(count)))
+        {
+            return false;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            zone[i] = static_cast<CardId>(p[0] | p[1] << 8);
+            p += 2;
+            if (zone[i] >= table.cardCount)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!has(4) || p[0] != StateFormatVersion)
+    {
+        return 0;
+    }
+    std::memset(static_cast<void *>(&s), 0, sizeof(GameState));
+    s.table = &table;
+    p++;
+
+    const std::uint8_t flags = *p++;
+    s.active = flags & 1;
+    s.phase = static_cast<Phase>(flags >> 1 & 7);
+    s.players[0].landPlayed = flags >> 4 & 1;
+    s.players[1].landPlayed = flags >> 5 & 1;
+    s.winner = (flags >> 6) - 1;
+    s.turn = static_cast<int>(get16());
+    if (s.phase > Phase::GameOver || s.winner > 1 || !has(5))
+    {
+        return 0;
+    }
+    s.rules = GameRules{p[0], p[1], p[2], p[3], p[4]};
+    p += 5;
+    if (!GameState::supportsRules(s.rules))
+    {
+        return 0;
+    }
+
+    for (PlayerState &ps : s.players)
+    {
+        if (!has(12))
+        {
+            return 0;
+        }
+        ps.hp = static_cast<std::int8_t>(*p++);
+        for (int c = 0; c < 5; c++)
+        {
+            ps.manaPool[c] = *p++;
+        }
+        ps.libraryCount = *p++;
+        const int handCount = *p++;
+        ps.landCount = *p++;
+        ps.creatureCount = *p++;
+        ps.enchantmentCount = *p++;
+        ps.discardCount = *p++;
+        if (ps.libraryCount > PlayerState::MaxLibrary || handCount > s.rules.handLimit || ps.landCount > PlayerState::MaxLands ||
+            ps.creatureCount > PlayerState::MaxCreatures || ps.enchantmentCount > PlayerState::MaxEnchantments || ps.discardCount > PlayerState::MaxDiscard)
+        {
+            return 0;
+        }
+
+        ps.hand.resize(handCount);
+        if (!readCards(ps.library, ps.libraryCount) || !readCards(ps.hand.data(), handCount) || !readCards(ps.lands, ps.landCount))
+        {
+            return 0;
+        }
+        for (int i = 0; i < ps.creatureCount; i++)
+        {
+            CreatureSlot &c = ps.creatures[i];
+            if (!readCards(&c.card, 1) || !has(1))
+            {
+                return 0;
+            }
+
+            const std::uint8_t bits = *p++;
+            const CardPrototype &proto = s.prototype(c.card);
+            c.firstStrike = bits & 1;
+            c.trample = bits >> 1 & 1;
+            c.tapped = bits >> 2 & 1;
+            c.attack = proto.attack;
+            c.hp = proto.hp;
+            c.toughness = proto.hp;
+            if (bits & 8)
+            {
+                if (!has(3))
+                {
+                    return 0;
+                }
+                c.attack = static_cast<std::int8_t>(*p++);
+                c.hp = static_cast<std::int8_t>(*p++);
+                c.toughness = static_cast<std::int8_t>(*p++);
+            }
+        }
+        if (!readCards(ps.enchantments, ps.enchantmentCount) || !readCards(ps.discard, ps.discardCount))
+        {
+            return 0;
+        }
+    }
+
+    std::fill(s.blockers, s.blockers + PlayerState::MaxCreatures, static_cast<std::int8_t>(-1));
+    s.blockCursor = -1;
+    if (!has(2))
+    {
+        return 0;
+    }
+    s.attackers = get16();
+    if (s.attackers != 0)
+    {
+        if (!has(3))
+        {
+            return 0;
+        }
+        s.usedBlockers = get16();
+        s.blockCursor = static_cast<std::int8_t>(*p++);
+        for (int a = 0; a < PlayerState::MaxCreatures; a++)
+        {
+            if (s.attackers & (1u << a))
+            {
+                if (!has(1))
+                {
+                    return 0;
+                }
+                s.blockers[a] = static_cast<std::int8_t>(*p++);
+            }
+        }
+    }
+
+    // combat indexes the creature slots with these, so every slot must exist and the combat must fit the phase
+    const std::uint32_t attackerSlots = (1u << s.players[s.active].creatureCount) - 1;
+    const std::uint32_t defenderSlots = (1u << s.players[1 - s.active].creatureCount) - 1;
+    std::uint32_t blocking = 0;
+    if ((s.attackers & ~attackerSlots) != 0 || (s.usedBlockers & ~defenderSlots) != 0 || s.getAttackerCount() > s.rules.attackSquadSize ||
+        (s.winner >= 0) != (s.phase == Phase::GameOver))
+    {
+        return 0;
+    }
+    for (int a = 0; a < PlayerState::MaxCreatures; a++)
+    {
+        const int b = s.blockers[a];
+        if (b < -1 || b >= s.players[1 - s.active].creatureCount || (b >= 0 && (blocking & (1u << b))))
+        {
+            return 0;
+        }
+        if (b >= 0)
+        {
+            blocking |= 1u << b;
+        }
+    }
+    if (blocking != s.usedBlockers)
+    {
+        return 0;
+    }
+    if (s.phase == Phase::Block)
+    {
+        if (s.blockCursor < 0 || s.blockCursor >= PlayerState::MaxCreatures || !(s.attackers & (1u << s.blockCursor)))
+        {
+            return 0;
+        }
+        for (int a = s.blockCursor; a < PlayerState::MaxCreatures; a++)
+        {
+            if (s.blockers[a] >= 0)
+            {
+                return 0; // blockers are chosen in attacker order, none is set from the cursor on
+            }
+        }
+    }
+    else if (s.blockCursor != -1 || s.usedBlockers != 0 || (s.phase != Phase::Attack && s.attackers != 0))
+    {
+        return 0;
+    }
+
+    if (!has(16))
+    {
+        return 0;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        s.rng |= static_cast<std::uint64_t>(*p++) << (8 * i);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        s.turnHash |= static_cast<std::uint64_t>(*p++) << (8 * i);
+    }
+    s.rebuildZoneHashes();
+    return static_cast<int>(p - in);
+} // deserializeState function
+//======================================================================================================================
+// Append v as a LEB128 varint: seven bits per byte, high bit set on every byte but the last
+inline void putVarint(std::vector<std::uint8_t> &out, std::uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+} // putVarint function
+//----------------------------------------------------------------------------------------------------------------------
+// Read a varint at pos and advance pos past it; returns false if the buffer ends inside it
+inline bool getVarint(const std::uint8_t *in, std::size_t size, std::size_t &pos, std::uint64_t &v)
+{
+    v = 0;
+    for (int shift = 0; pos < size && shift < 64; shift += 7)
+    {
+        const std::uint8_t b = in[pos++];
+        v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+} // getVarint function
+//======================================================================================================================
+/**
+ * @class ReplayLog
+ * @brief A recorded headless game: the shuffle seed and every decision as a varint action index.
+ *
+ * The engine draws all its randomness from the rng that reset() seeds, so the seed and the decisions are enough to
+ * re-execute the game exactly; no rng draw has to be stored. Recording a decision appends one or two bytes.
+ *
+ * With a keyframe interval of K turns the log also keeps a serializeState() snapshot of the first decision point of
+ * every K-th turn, so seekTurn() only re-simulates from the nearest keyframe and verifyReplayParallel() can check the
+ * segments between keyframes on separate threads.
+ *
+ * The log also keeps the game's turn hash chain after every turn, so replayGame() reports a divergence at the end of
+ * the first turn that differs instead of only at the end of the game.
+ *
+ * The log keeps the rules of the game it recorded and the cardTableHash() of its card pool, both taken from the first
+ * state it sees. A variant format replays with its own hand limit, deck size and squad size, and a replay against a
+ * different pool (after a reload, say) is rejected up front instead of failing somewhere in the middle.
+ *
+ * Saved layout: "MGRP", version, varint seed, the five GameRules values as varints, the uint64 little-endian card
+ * table hash, varint decision count, varint byte length of the decision stream and
+ * the stream, varint keyframe count and for each keyframe varint turn, varint decision index, varint stream offset,
+ * varint state length and the state, varint turn hash count and the uint64 little-endian hashes, then winner + 1, varint turn and the uint64 little-endian hash() of the final
+ * state. A log that was never finished stores winner + 1 = 0xff and no turn or hash.
+ */
+class ReplayLog
+{
+public:
+    static constexpr std::uint8_t Version = 6;
+
+    /**
+     * @struct Keyframe
+     * @brief A snapshot of the state before one recorded decision.
+     */
+    struct Keyframe
+    {
+        int turn;
+        int decision;       // index of the first decision made from this state
+        std::size_t offset; // byte offset of that decision in the stream
+        std::vector<std::uint8_t> state;
+    };
+
+    /**
+     * @brief Starts an empty log for a game of the active card table's decks reset with seed.
+     *
+     * @param seed The seed given to GameState::reset().
+     * @param keyframeInterval Turns between keyframes, 0 for none.
+     */
+    explicit ReplayLog(std::uint64_t seed = 0, int keyframeInterval = 0) : seed(seed), keyframeInterval(keyframeInterval), nextKeyframeTurn(keyframeInterval) {}
+
+    /**
+     * @brief Appends a decision; call it with every move given to applyMove(), in order.
+     *
+     * @param before The state the move is applied to.
+     * @param m The move.
+     */
+    void record(const GameState &before, const Move &m)
+    {
+        if (keyframeInterval > 0 && before.turn >= nextKeyframeTurn)
+        {
+            std::uint8_t buffer[MaxSerializedStateBytes];
+            const int size = serializeState(before, buffer);
+
+            keyframes.push_back(Keyframe{before.turn, decisionCount, decisions.size(), std::vector<std::uint8_t>(buffer, buffer + size)});
+            nextKeyframeTurn = before.turn + keyframeInterval;
+        }
+        noteTurnHash(before);
+        putVarint(decisions, static_cast<std::uint64_t>(actionIndex(m)));
+        decisionCount++;
+    }
+
+    /**
+     * @brief Stores the outcome that a replay has to reproduce.
+     */
+    void finish(const GameState &s)
+    {
+        noteTurnHash(s);
+        finished = true;
+        winner = s.winner;
+        turn = s.turn;
+        finalHash = s.hash();
+    }
+
+    std::uint64_t getSeed() const { return seed; }
+    const GameRules &getRules() const { return rules; }
+    std::uint64_t getTableHash() const { return tableHash; }
+    int getDecisionCount() const { return decisionCount; }
+    const std::vector<std::uint8_t> &getDecisions() const { return decisions; }
+    const std::vector<Keyframe> &getKeyframes() const { return keyframes; }
+    const std::vector<std::uint64_t> &getTurnHashes() const { return turnHashes; }
+    bool isFinished() const { return finished; }
+    int getWinner() const { return winner; }
+    int getTurn() const { return turn; }
+    std::uint64_t getFinalHash() const { return finalHash; }
+
+    /**
+     * @brief Appends the saved form of the log to out.
+     */
+    void save(std::vector<std::uint8_t> &out) const
+    {
+        out.insert(out.end(), {'M', 'G', 'R', 'P', Version});
+        putVarint(out, seed);
+        for (int value : {rules.startingHp, rules.handLimit, rules.openingHand, rules.deckSize, rules.attackSquadSize})
+        {
+            putVarint(out, static_cast<std::uint64_t>(value));
+        }
+        for (int i = 0; i < 8; i++)
+        {
+            out.push_back(static_cast<std::uint8_t>(tableHash >> (8 * i)));
+        }
+        putVarint(out, static_cast<std::uint64_t>(decisionCount));
+        putVarint(out, decisions.size());
+        out.insert(out.end(), decisions.begin(), decisions.end());
+        putVarint(out, keyframes.size());
+        for (const Keyframe &k : keyframes)
+        {
+            putVarint(out, static_cast<std::uint64_t>(k.turn));
+            putVarint(out, static_cast<std::uint64_t>(k.decision));
+            putVarint(out, k.offset);
+            putVarint(out, k.state.size());
+            out.insert(out.end(), k.state.begin(), k.state.end());
+        }
+        putVarint(out, turnHashes.size());
+        for (std::uint64_t h : turnHashes)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                out.push_back(static_cast<std::uint8_t>(h >> (8 * i)));
+            }
+        }
+        out.push_back(static_cast<std::uint8_t>(finished ? winner + 1 : 0xff));
+        if (finished)
+        {
+            putVarint(out, static_cast<std::uint64_t>(turn));
+            for (int i = 0; i < 8; i++)
+            {
+                out.push_back(static_cast<std::uint8_t>(finalHash >> (8 * i)));
+            }
+        }
+    }
+
+    /**
+     * @brief Replaces the log with a saved one.
+     *
+     * @return False (and the log is left empty) if the input is not a complete saved log.
+     */
+    bool load(const std::uint8_t *in, std::size_t size)
+    {
+        std::size_t pos = 5;
+        std::uint64_t count = 0;
+        std::uint64_t length = 0;
+        std::uint64_t turnValue = 0;
+        std::uint64_t keyframeCount = 0;
+        std::uint64_t hashCount = 0;
+
+        *this = ReplayLog();
+        if (size < pos || std::memcmp(in, "MGRP", 4) != 0 || in[4] != Version || !getVarint(in, size, pos, seed) || !getRules(in, size, pos) ||
+            size - pos < 8 || !getTableHash(in, pos) || !getVarint(in, size, pos, count) || !getVarint(in, size, pos, length) || length >= size - pos)
+        {
+            *this = ReplayLog();
+            return false;
+        }
+        decisions.assign(in + pos, in + pos + length);
+        decisionCount = static_cast<int>(count);
+        pos += length;
+
+        if (!getVarint(in, size, pos, keyframeCount))
+        {
+            *this = ReplayLog();
+            return false;
+        }
+        for (std::uint64_t k = 0; k < keyframeCount; k++)
+        {
+            std::uint64_t kTurn = 0;
+            std::uint64_t kDecision = 0;
+            std::uint64_t kOffset = 0;
+            std::uint64_t kLength = 0;
+            if (!getVarint(in, size, pos, kTurn) || !getVarint(in, size, pos, kDecision) || !getVarint(in, size, pos, kOffset) ||
+                !getVarint(in, size, pos, kLength) || kLength >= size - pos || kDecision > count || kOffset > length || kTurn > INT_MAX)
+            {
+                *this = ReplayLog();
+                return false;
+            }
+            // seekTurn() binary searches the keyframes and verifyReplayParallel() runs the segments between them, so
+            // they have to be in game order
+            if (!keyframes.empty() && (static_cast<int>(kTurn) <= keyframes.back().turn || static_cast<int>(kDecision) < keyframes.back().decision ||
+                                       kOffset < keyframes.back().offset))
+            {
+                *this = ReplayLog();
+                return false;
+            }
+            keyframes.push_back(Keyframe{static_cast<int>(kTurn), static_cast<int>(kDecision), static_cast<std::size_t>(kOffset),
+                                         std::vector<std::uint8_t>(in + pos, in + pos + kLength)});
+            pos += kLength;
+        }
+
+        if (!getVarint(in, size, pos, hashCount) || pos == size || hashCount > (size - pos - 1) / 8)
+        {
+            *this = ReplayLog();
+            return false;
+        }
+        for (std::uint64_t k = 0; k < hashCount; k++)
+        {
+            std::uint64_t h = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                h |= static_cast<std::uint64_t>(in[pos++]) << (8 * i);
+            }
+            turnHashes.push_back(h);
+        }
+
+        const std::uint8_t outcome = in[pos++];
+        if (outcome != 0xff)
+        {
+            if (!getVarint(in, size, pos, turnValue) || size - pos < 8)
+            {
+                *this = ReplayLog();
+                return false;
+            }
+            finished = true;
+            winner = outcome - 1;
+            turn = static_cast<int>(turnValue);
+            for (int i = 0; i < 8; i++)
+            {
+                finalHash |= static_cast<std::uint64_t>(in[pos++]) << (8 * i);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Writes the saved log to a file; returns false if it can not be written.
+     */
+    bool saveFile(const std::string &path) const
+    {
+        std::vector<std::uint8_t> bytes;
+        save(bytes);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * @brief Reads a log written by saveFile(); returns false if the file is missing or not a valid log.
+     */
+    bool loadFile(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return load(bytes.data(), bytes.size());
+    }
+
+private:
+    std::uint64_t seed;
+    GameRules rules = StandardRules;
+    std::uint64_t tableHash = cardTableHash(BuiltinCardTable);
+    int keyframeInterval;
+    int nextKeyframeTurn;
+    std::vector<std::uint8_t> decisions;
+    std::vector<Keyframe> keyframes;
+    std::vector<std::uint64_t> turnHashes;
+    std::uint64_t lastTurnHash = 0;
+    int decisionCount = 0;
+    bool finished = false;
+    int winner = -1;
+    int turn = 0;
+    std::uint64_t finalHash = 0;
+
+    // Keep every new link of the turn hash chain; the chain only changes when a turn ends
+    void noteTurnHash(const GameState &s)
+    {
+        if (decisionCount == 0)
+        {
+            lastTurnHash = s.getTurnHash();
+            rules = s.rules;
+            tableHash = cardTableHash(s.getCardTable());
+        }
+        else if (s.getTurnHash() != lastTurnHash)
+        {
+            lastTurnHash = s.getTurnHash();
+            turnHashes.push_back(lastTurnHash);
+        }
+    }
+
+    // Read the five rules values of a saved log; false if they are missing or the engine can not play them
+    bool getRules(const std::uint8_t *in, std::size_t size, std::size_t &pos)
+    {
+        std::uint64_t values[5];
+        for (std::uint64_t &v : values)
+        {
+            if (!getVarint(in, size, pos, v) || v > 255)
+            {
+                return false;
+            }
+        }
+        rules = GameRules{static_cast<int>(values[0]), static_cast<int>(values[1]), static_cast<int>(values[2]), static_cast<int>(values[3]),
+                          static_cast<int>(values[4])};
+        return GameState::supportsRules(rules);
+    }
+
+    // Read the card table hash; the caller checked that 8 bytes are left
+    bool getTableHash(const std::uint8_t *in, std::size_t &pos)
+    {
+        tableHash = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            tableHash |= static_cast<std::uint64_t>(in[pos++]) << (8 * i);
+        }
+        return true;
+    }
+}; // ReplayLog class
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @struct ReplayResult
+ * @brief What a replay reproduced.
+ */
+struct ReplayResult
+{
+    bool ok;           // every decision was legal and, for a finished log, the outcome and final hash match
+    int applied;       // decisions applied before the replay stopped
+    const char *error; // why ok is false, or nullptr
+    GameState state;   // the state after the last applied decision
+}; // ReplayResult struct
+//----------------------------------------------------------------------------------------------------------------------
+// Apply count recorded decisions read from byte pos of the stream, advancing pos; returns nullptr or the error
+const char *applyRecorded(GameState &s, const std::vector<std::uint8_t> &stream, std::size_t &pos, int count, int &applied)
+{
+    Move moves[GameState::MaxMoves];
+
+    for (int d = 0; d < count; d++, applied++)
+    {
+        std::uint64_t action = 0;
+        if (!getVarint(stream.data(), stream.size(), pos, action))
+        {
+            return "decision stream ends early";
+        }
+
+        const int n = s.generateMoves(moves);
+        int chosen = -1;
+        for (int m = 0; m < n && chosen < 0; m++)
+        {
+            if (static_cast<std::uint64_t>(actionIndex(moves[m])) == action)
+            {
+                chosen = m;
+            }
+        }
+        if (chosen < 0)
+        {
+            return "recorded decision is not legal";
+        }
+        s.applyMove(moves[chosen]);
+    }
+    return nullptr;
+} // applyRecorded function
+//----------------------------------------------------------------------------------------------------------------------
+// Check that a replayed state ends the way the recording did
+bool matchesOutcome(const ReplayLog &log, const GameState &s)
+{
+    return !log.isFinished() || (s.winner == log.getWinner() && s.turn == log.getTurn() && s.hash() == log.getFinalHash());
+} // matchesOutcome function
+//----------------------------------------------------------------------------------------------------------------------
+// Re-execute a recorded game headless with the card pool it was recorded with and check that it ends the way it did
+ReplayResult replayGame(const ReplayLog &log, const CardTable &table = getActiveCardTable())
+{
+    ReplayResult result{false, 0, nullptr, GameState()};
+    const std::vector<std::uint64_t> &turnHashes = log.getTurnHashes();
+    std::size_t pos = 0;
+    std::size_t turnsChecked = 0;
+
+    if (cardTableHash(table) != log.getTableHash())
+    {
+        result.error = "the game was recorded with a different card table";
+        return result;
+    }
+    result.state.reset(log.getSeed(), table, log.getRules());
+    for (std::uint64_t last = result.state.getTurnHash(); !result.error && result.applied < log.getDecisionCount();)
+    {
+        result.error = applyRecorded(result.state, log.getDecisions(), pos, 1, result.applied);
+        if (!result.error && result.state.getTurnHash() != last)
+        {
+            last = result.state.getTurnHash();
+            if (turnsChecked < turnHashes.size() && turnHashes[turnsChecked++] != last)
+            {
+                result.error = "state diverged from the recording at the end of a turn";
+            }
+        }
+    }
+    if (!result.error && !matchesOutcome(log, result.state))
+    {
+        result.error = "outcome differs from the recording";
+    }
+    result.ok = result.error == nullptr;
+    return result;
+} // replayGame function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Rebuilds the state at the first decision point of a turn, re-simulating only from the nearest keyframe.
+ *
+ * @param log The recorded game.
+ * @param turn The turn to jump to; a turn past the end of the game gives the last recorded state.
+ * @param out Receives the state.
+ * @param table The card pool the game was recorded with.
+ * @return False if the card pool is not the recorded one, a keyframe is corrupt or a recorded decision is not legal.
+ */
+bool seekTurn(const ReplayLog &log, int turn, GameState &out, const CardTable &table = getActiveCardTable())
+{
+    const std::vector<ReplayLog::Keyframe> &keyframes = log.getKeyframes();
+    const auto later = std::upper_bound(keyframes.begin(), keyframes.end(), turn, [](int t, const ReplayLog::Keyframe &k)
+                                        { return t < k.turn; });
+    int decision = 0;
+    std::size_t offset = 0;
+    int applied = 0;
+
+    if (cardTableHash(table) != log.getTableHash())
+    {
+        return false;
+    }
+    if (later == keyframes.begin())
+    {
+        out.reset(log.getSeed(), table, log.getRules());
+    }
+    else
+    {
+        const ReplayLog::Keyframe &k = *(later - 1);
+        if (!deserializeState(k.state.data(), k.state.size(), out, table))
+        {
+            return false;
+        }
+        decision = k.decision;
+        offset = k.offset;
+    }
+
+    // step one decision at a time so the replay stops right when the turn starts
+    for (; decision < log.getDecisionCount() && out.turn < turn; decision++)
+    {
+        if (applyRecorded(out, log.getDecisions(), offset, 1, applied))
+        {
+            return false;
+        }
+    }
+    return true;
+} // seekTurn function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Checks a recorded game segment by segment on several threads.
+ *
+ * Segment i starts from keyframe i (segment 0 from the seed) and must reach exactly the next keyframe's state, or
+ * for the last segment the recorded outcome. The segments share nothing, so they run in parallel.
+ *
+ * @param log The recorded game.
+ * @param threadCount Number of threads, 0 for one per hardware thread.
+ * @param table The card pool the game was recorded with.
+ * @return The index of the first segment that does not match, 0 if the card pool is not the recorded one, or -1 if
+ * the whole game checks out.
+ */
+int verifyReplayParallel(const ReplayLog &log, int threadCount = 0, const CardTable &table = getActiveCardTable())
+{
+    const std::vector<ReplayLog::Keyframe> &keyframes = log.getKeyframes();
+    const int segments = static_cast<int>(keyframes.size()) + 1;
+    std::vector<std::uint8_t> valid(segments, 0);
+    std::atomic<int> nextSegment{0};
+
+    if (cardTableHash(table) != log.getTableHash())
+    {
+        return 0;
+    }
+    if (threadCount <= 0)
+    {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    auto check = [&log, &keyframes, &table, segments](int i)
+    {
+        GameState s;
+        int applied = 0;
+
+        if (i == 0)
+        {
+            s.reset(log.getSeed(), table, log.getRules());
+        }
+        else if (!deserializeState(keyframes[i - 1].state.data(), keyframes[i - 1].state.size(), s, table))
+        {
+            return false;
+        }
+
+        const int first = i == 0 ? 0 : keyframes[i - 1].decision;
+        const int last = i + 1 < segments ? keyframes[i].decision : log.getDecisionCount();
+        std::size_t offset = i == 0 ? 0 : keyframes[i - 1].offset;
+        if (applyRecorded(s, log.getDecisions(), offset, last - first, applied))
+        {
+            return false;
+        }
+        if (i + 1 == segments)
+        {
+            return matchesOutcome(log, s);
+        }
+
+        std::uint8_t buffer[MaxSerializedStateBytes];
+        const int size = serializeState(s, buffer);
+        return static_cast<std::size_t>(size) == keyframes[i].state.size() && std::memcmp(buffer, keyframes[i].state.data(), size) == 0;
+    };
+
+    auto work = [&]()
+    {
+        for (int i = nextSegment.fetch_add(1); i < segments; i = nextSegment.fetch_add(1))
+        {
+            valid[i] = check(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < std::min(threadCount, segments); t++)
+    {
+        workers.emplace_back(work);
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+
+    for (int i = 0; i < segments; i++)
+    {
+        if (!valid[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+} // verifyReplayParallel function
+//======================================================================================================================
+/**
+ * @class AiPlayer
+ * @brief A fair bot for every decision point of the game under a per-decision time budget.
+ *
+ * The attack squad, the blockers, the card to play and the target of Terror, Flood, Disenchant, Rage, Slow and
+ * LightningBolt are all moves of the headless engine, so one decide() call answers any of them. Every call searches
+ * with IsmctsPlayer until its deadline and appends a SearchStats record to the latency log, except an attack that
+ * LethalSolver proves lethal, which is played at once and logged with no playouts. Blocks follow BlockSolver the same
+ * way as long as its blocks keep the defender alive; otherwise they are searched.
+ */
+class AiPlayer
+{
+public:
+    /**
+     * @brief Creates a bot.
+     *
+     * @param budgetMs Wall-clock budget of every decision in milliseconds.
+     * @param threadCount Number of search threads, 0 for one per hardware thread.
+     */
+    explicit AiPlayer(double budgetMs = 100.0, int threadCount = 0) : budgetMs(budgetMs), search(threadCount) {}
+
+    /**
+     * @brief Chooses the next move of the player to move in state.
+     */
+    Move decide(const GameState &state)
+    {
+        // a squad that kills through any blocks needs no search: add every creature that can still join, then attack
+        if (hasLethalAttack(state))
+        {
+            Move moves[GameState::MaxMoves];
+            const int n = state.generateMoves(moves);
+
+            log.push_back(SearchStats{decisionName(state), 0, 0, 0.0, 0.0});
+            return moves[n > 1 ? 1 : 0];
+        }
+
+        Move block;
+        if (solveBlock(state, block))
+        {
+            log.push_back(SearchStats{decisionName(state), 0, 0, 0.0, 0.0});
+            return block;
+        }
+
+        const SearchDeadline deadline(budgetMs);
+        const Move m = search.chooseMove(state, deadline);
+
+        log.emplace_back(search.getLastStats());
+        return m;
+    }
+
+    /**
+     * @brief Returns the stats of every decision made so far.
+     */
+    const std::vector<SearchStats> &getLog() { return log; }
+
+    /**
+     * @brief Prints the latency log, one decision per line.
+     */
+    void printLog()
+    {
+        for (auto it = log.begin(); it != log.end(); it++)
+        {
+            std::cout << it->decision << ": " << it->nodes << " playouts, depth " << it->depth << ", " << it->elapsedMs
+                      << " ms, " << static_cast<long long>(it->nodesPerSecond) << " playouts/s" << std::endl;
+        }
+    }
+
+private:
+    double budgetMs;
+    IsmctsPlayer search;
+    BlockSolver blockSolver; // kept between decisions so its memo table is only allocated once
+    std::vector<SearchStats> log;
+
+    // Block the current attacker the way BlockSolver blocks the attackers still unblocked, unless those blocks let
+    // through enough damage to kill the defender; then the search has to find something better
+    bool solveBlock(const GameState &state, Move &out)
+    {
+        if (state.phase != Phase::Block)
+        {
+            return false;
+        }
+
+        static_assert(PlayerState::MaxCreatures <= BlockSolver::MaxCreatures, "every creature of a side of the engine must fit the block solver");
+
+        const PlayerState &attacker = state.players[state.active];
+        const PlayerState &defender = state.players[1 - state.active];
+        BlockSolver::CreatureList attackers;
+        BlockSolver::CreatureList defenders;
+        StaticVector<int, BlockSolver::MaxCreatures> defenderSlot;
+
+        for (int c = state.getBlockCursor(); c < attacker.creatureCount; c++)
+        {
+            if (state.attackers & (1u << c))
+            {
+                const CreatureSlot &cs = attacker.creatures[c];
+                attackers.push_back(CreatureStats{cs.attack, cs.hp, cs.firstStrike, cs.trample});
+            }
+        }
+        for (int c = 0; c < defender.creatureCount; c++)
+        {
+            if (!defender.creatures[c].tapped && !(state.usedBlockers & (1u << c)))
+            {
+                const CreatureSlot &cs = defender.creatures[c];
+                defenders.push_back(CreatureStats{cs.attack, cs.hp, cs.firstStrike, cs.trample});
+                defenderSlot.push_back(c);
+            }
+        }
+
+        const BlockSolver::Assignment blocks = blockSolver.solve(attackers, defenders);
+        int damage = 0;
+        for (int a = 0; a < blocks.size(); a++)
+        {
+            damage += blocks[a] == BlockSolver::NoBlock ? std::max(attackers[a].attack, 0)
+                                                        : CombatTable::lookup(attackers[a], defenders[blocks[a]]).trampleDamage;
+        }
+        if (blocks.size() == 0 || damage >= defender.hp)
+        {
+            return false;
+        }
+
+        out = blocks[0] == BlockSolver::NoBlock ? Move{MoveKind::Pass, 0, Move::TargetNone}
+                                                : Move{MoveKind::Block, static_cast<std::uint8_t>(defenderSlot[blocks[0]]), Move::TargetNone};
+        return true;
+    }
+}; // AiPlayer class
+//======================================================================================================================
+/**
+ * @class ObservationEncoder
+ * @brief Writes a game state as a fixed-size float tensor plus a legal-action mask, without allocating.
+ *
+ * The layout is stable; offsets are the constants below. The observer's side comes first, then the opponent's, then
+ * the global block. A side is SideHeader values (hp, the five mana pool counts in CardColor order, library size,
+ * discard size, land played this turn, hand size) followed by one SlotFeatures record for every hand, creature, land
+ * and enhancement slot in that order. A slot record is: present, card id + 1 (0 when empty or hidden), zone (see
+ * Zone), tapped, attack, hp left, toughness, first strike, trample, in combat (attacking or blocking). Only creatures
+ * carry the stats and keywords. Cards in the opponent's hand are present but hidden, and the libraries are only
+ * counted. The global block is the phase one-hot (Phase order), observer to move, observer is the active player and
+ * the attacker slot being blocked + 1 (0 outside the block phase).
+ *
+ * The mask holds ActionCount bytes, 1 for every actionIndex() that is legal for the player to move.
+ */
+class ObservationEncoder
+{
+public:
+    enum Zone
+    {
+        NoZone,
+        HandZone,
+        CreatureZone,
+        LandZone,
+        EnchantmentZone
+    };
+
+    static constexpr int SlotFeatures = 10;
+    static constexpr int SideHeader = 10;
+    static constexpr int HandOffset = SideHeader;
+    static constexpr int CreatureOffset = HandOffset + PlayerState::MaxHand * SlotFeatures;
+    static constexpr int LandOffset = CreatureOffset + PlayerState::MaxCreatures * SlotFeatures;
+    static constexpr int EnchantmentOffset = LandOffset + PlayerState::MaxLands * SlotFeatures;
+    static constexpr int SideSize = EnchantmentOffset + PlayerState::MaxEnchantments * SlotFeatures;
+    static constexpr int GlobalOffset = 2 * SideSize;
+    static constexpr int Size = GlobalOffset + 5 + 3;
+
+    /**
+     * @brief Writes the observation of a state seen by observer.
+     *
+     * @param s The state.
+     * @param observer The player whose view is encoded.
+     * @param out Buffer of Size floats.
+     * @param mask Buffer of ActionCount bytes, or nullptr to skip the mask.
+     */
+    static void encode(const GameState &s, int observer, float *out, std::uint8_t *mask)
+    {
+        std::fill(out, out + Size, 0.0f);
+
+        for (int side = 0; side < 2; side++)
+        {
+            const int p = side == 0 ? observer : 1 - observer;
+            const PlayerState &ps = s.players[p];
+            float *f = out + side * SideSize;
+
+            f[0] = static_cast<float>(ps.hp);
+            for (int c = 0; c < 5; c++)
+            {
+                f[1 + c] = static_cast<float>(ps.manaPool[c]);
+            }
+            f[6] = static_cast<float>(ps.libraryCount);
+            f[7] = static_cast<float>(ps.discardCount);
+            f[8] = ps.landPlayed ? 1.0f : 0.0f;
+            f[9] = static_cast<float>(ps.hand.size());
+
+            for (int i = 0; i < ps.hand.size(); i++)
+            {
+                writeCard(f + HandOffset + i * SlotFeatures, side == 0 ? ps.hand[i] + 1 : 0, HandZone, false);
+            }
+            for (int i = 0; i < ps.creatureCount; i++)
+            {
+                const CreatureSlot &c = ps.creatures[i];
+                float *slot = f + CreatureOffset + i * SlotFeatures;
+                const bool inCombat = p == s.active ? (s.attackers & (1u << i)) != 0 : (s.usedBlockers & (1u << i)) != 0;
+
+                writeCard(slot, c.card + 1, CreatureZone, c.tapped);
+                slot[4] = c.attack;
+                slot[5] = c.hp;
+                slot[6] = c.toughness;
+                slot[7] = c.firstStrike ? 1.0f : 0.0f;
+                slot[8] = c.trample ? 1.0f : 0.0f;
+                slot[9] = inCombat ? 1.0f : 0.0f;
+            }
+            for (int i = 0; i < ps.landCount; i++)
+            {
+                // lands are tapped for mana at the start of their owner's turn
+                writeCard(f + LandOffset + i * SlotFeatures, ps.lands[i] + 1, LandZone, p == s.active);
+            }
+            for (int i = 0; i < ps.enchantmentCount; i++)
+            {
+                writeCard(f + EnchantmentOffset + i * SlotFeatures, ps.enchantments[i] + 1, EnchantmentZone, false);
+            }
+        }
+
+        float *g = out + GlobalOffset;
+        g[static_cast<int>(s.phase)] = 1.0f;
+        g[5] = s.toMove() == observer ? 1.0f : 0.0f;
+        g[6] = s.active == observer ? 1.0f : 0.0f;
+        g[7] = s.phase == Phase::Block ? static_cast<float>(s.blockCursor + 1) : 0.0f;
+
+        if (mask)
+        {
+            Move moves[GameState::MaxMoves];
+            const int n = s.generateMoves(moves);
+
+            std::fill(mask, mask + ActionCount, static_cast<std::uint8_t>(0));
+            for (int m = 0; m < n; m++)
+            {
+                mask[actionIndex(moves[m])] = 1;
+            }
+        }
+    }
+
+private:
+    static void writeCard(float *slot, int id, Zone zone, bool tapped)
+    {
+        slot[0] = 1.0f;
+        slot[1] = static_cast<float>(id);
+        slot[2] = static_cast<float>(zone);
+        slot[3] = tapped ? 1.0f : 0.0f;
+    }
+}; // ObservationEncoder class
+//======================================================================================================================
+/**
+ * @class BatchEnv
+ * @brief N independent headless games stepped in lockstep for reinforcement learning.
+ *
+ * step() takes one action index (see actionIndex()) per game, applies it for the player to move and writes the
+ * observation, reward and done flag of every game into flat arrays that are reused between steps. Rewards are given
+ * to the player who made the decision: +1 when it ends the game in their favour, -1 when they lose and 0 otherwise;
+ * the other player's reward is the negation.
+ * A game that is over or hits MaxEpisodeSteps is reset with its next seed in the same step, so the observation
+ * returned with done set is already the first observation of the next game.
+ *
+ * An action that is not legal in its game is replaced by the first legal move, which is Pass whenever passing is
+ * allowed, and the game is flagged in illegal() for that step so a learner can penalize or mask it. Games where the
+ * player to move has an attack that kills through any blocks (see hasLethalAttack()) are flagged in lethal().
+ *
+ * An environment created with recordReplays keeps a ReplayLog of every game; the log of a game that just ended is
+ * read with replay() until its slot ends the next one.
+ *
+ * Games are split in contiguous ranges over a WorkerPool that is started with the environment, one worker per
+ * MinGamesPerThread games up to the thread count; small batches are stepped on the calling thread alone.
+ */
+class BatchEnv
+{
+public:
+    static constexpr int ObservationSize = ObservationEncoder::Size;
+    static constexpr int MaxEpisodeSteps = 2000;
+
+    /**
+     * @brief Creates and resets the games.
+     *
+     * @param envCount Number of games.
+     * @param seed Seed of the first game; game i of episode e uses seed + i + e * envCount.
+     * @param threadCount Number of worker threads, 0 for one per hardware thread.
+     * @param recordReplays Whether to keep a ReplayLog of every game.
+     */
+    BatchEnv(int envCount, std::uint64_t seed, int threadCount = 0, bool recordReplays = false)
+        : envCount(envCount), workers(workerCount(envCount, threadCount)), games(envCount), episodeSteps(envCount), nextSeed(envCount),
+          observationBuffer(static_cast<std::size_t>(envCount) * ObservationSize),
+          maskBuffer(static_cast<std::size_t>(envCount) * ActionCount), rewardBuffer(envCount), doneBuffer(envCount), illegalBuffer(envCount),
+          lethalBuffer(envCount), playerBuffer(envCount)
+    {
+        for (int i = 0; i < envCount; i++)
+        {
+            nextSeed[i] = seed + static_cast<std::uint64_t>(i);
+        }
+        if (recordReplays)
+        {
+            replays.resize(envCount);
+            finishedReplays.resize(envCount);
+        }
+        reset();
+    }
+
+    /**
+     * @brief Starts a new game in every slot and writes their first observations.
+     */
+    void reset()
+    {
+        for (int i = 0; i < envCount; i++)
+        {
+            resetGame(i);
+            rewardBuffer[i] = 0.0f;
+            doneBuffer[i] = 0;
+            illegalBuffer[i] = 0;
+        }
+    }
+
+    /**
+     * @brief Advances every game by one decision.
+     *
+     * @param actions envCount action indices.
+     */
+    void step(const int *actions)
+    {
+        const int perWorker = (envCount + workers.size() - 1) / workers.size();
+
+        workers.run([this, actions, perWorker](int w)
+                    { stepRange(actions, std::min(w * perWorker, envCount), std::min((w + 1) * perWorker, envCount)); });
+    }
+
+    /**
+     * @brief Returns the number of games.
+     */
+    int size() const { return envCount; }
+
+    /**
+     * @brief Returns envCount x ObservationSize values in the ObservationEncoder layout, each game seen by its player to
+     * move.
+     */
+    const float *observations() const { return observationBuffer.data(); }
+
+    /**
+     * @brief Returns envCount x ActionCount legal-action masks.
+     */
+    const std::uint8_t *masks() const { return maskBuffer.data(); }
+
+    /**
+     * @brief Returns the reward of the last step for the player who made it, one per game.
+     */
+    const float *rewards() const { return rewardBuffer.data(); }
+
+    /**
+     * @brief Returns 1 for every game that ended (and was reset) in the last step.
+     */
+    const std::uint8_t *dones() const { return doneBuffer.data(); }
+
+    /**
+     * @brief Returns 1 for every game whose action in the last step was not legal and was replaced.
+     */
+    const std::uint8_t *illegal() const { return illegalBuffer.data(); }
+
+    /**
+     * @brief Returns 1 for every game whose player to move has a lethal attack, 0 outside the Attack phase.
+     */
+    const std::uint8_t *lethal() const { return lethalBuffer.data(); }
+
+    /**
+     * @brief Returns the player to move in every game.
+     */
+    const int *players() const { return playerBuffer.data(); }
+
+    /**
+     * @brief Returns the state of one game.
+     */
+    const GameState &game(int index) const { return games[index]; }
+
+    /**
+     * @brief Returns the log of the last game that ended in a slot, empty before the first one or without
+     * recordReplays.
+     */
+    const ReplayLog &replay(int index) const
+    {
+        static const ReplayLog none;
+        return finishedReplays.empty() ? none : finishedReplays[index];
+    }
+
+private:
+    static constexpr int MinGamesPerThread = 256; // below this the wake-up costs more than the steps
+
+    int envCount;
+    WorkerPool workers;
+    std::vector<GameState> games;
+    std::vector<int> episodeSteps;
+    std::vector<std::uint64_t> nextSeed;
+    std::vector<float> observationBuffer;
+    std::vector<std::uint8_t> maskBuffer;
+    std::vector<float> rewardBuffer;
+    std::vector<std::uint8_t> doneBuffer;
+    std::vector<std::uint8_t> illegalBuffer;
+    std::vector<std::uint8_t> lethalBuffer;
+    std::vector<int> playerBuffer;
+    std::vector<ReplayLog> replays;         // the running games, empty without recordReplays
+    std::vector<ReplayLog> finishedReplays; // the last game that ended in every slot
+
+    // One worker per MinGamesPerThread games, at least one and at most threadCount (0 for the hardware threads)
+    static int workerCount(int envCount, int threadCount)
+    {
+        if (threadCount <= 0)
+        {
+            threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        return std::max(1, std::min(threadCount, envCount / MinGamesPerThread));
+    }
+
+    void resetGame(int i)
+    {
+        games[i].reset(nextSeed[i]);
+        if (!replays.empty())
+        {
+            replays[i] = ReplayLog(nextSeed[i]);
+        }
+        nextSeed[i] += static_cast<std::uint64_t>(envCount);
+        episodeSteps[i] = 0;
+        observe(i);
+    }
+
+    void observe(int i)
+    {
+        playerBuffer[i] = games[i].toMove();
+        lethalBuffer[i] = hasLethalAttack(games[i]);
+        ObservationEncoder::encode(games[i], playerBuffer[i], observationBuffer.data() + static_cast<std::size_t>(i) * ObservationSize,
+                                   maskBuffer.data() + static_cast<std::size_t>(i) * ActionCount);
+    }
+
+    void stepRange(const int *actions, int begin, int end)
+    {
+        Move moves[GameState::MaxMoves];
+
+        for (int i = begin; i < end; i++)
+        {
+            GameState &s = games[i];
+            const int player = s.toMove();
+            const int n = s.generateMoves(moves);
+            int chosen = -1;
+
+            for (int m = 0; m < n; m++)
+            {
+                if (actionIndex(moves[m]) == actions[i])
+                {
+                    chosen = m;
+                    break;
+                }
+            }
+            illegalBuffer[i] = chosen < 0;
+            if (n > 0)
+            {
+                if (!replays.empty())
+                {
+                    replays[i].record(s, moves[chosen < 0 ? 0 : chosen]);
+                }
+                s.applyMove(moves[chosen < 0 ? 0 : chosen]);
+            }
+
+            rewardBuffer[i] = s.isOver() ? (s.winner == player ? 1.0f : -1.0f) : 0.0f;
+            doneBuffer[i] = s.isOver() || ++episodeSteps[i] >= MaxEpisodeSteps;
+            if (doneBuffer[i])
+            {
+                if (!replays.empty())
+                {
+                    replays[i].finish(s);
+                    finishedReplays[i] = std::move(replays[i]);
+                }
+                resetGame(i);
+            }
+            else
+            {
+                observe(i);
+            }
+        }
+    }
+}; // BatchEnv class
+//======================================================================================================================
+// Compress a byte buffer by replacing every run of zero bytes with a 0 byte and the run length (1..255)
+void rleEncode(const std::uint8_t *in, std::size_t size, std::vector<std::uint8_t> &out)
+{
+    out.clear();
+    for (std::size_t i = 0; i < size;)
+    {
+        if (in[i] != 0)
+        {
+            out.push_back(in[i++]);
+            continue;
+        }
+
+        std::size_t run = 0;
+        while (i < size && in[i] == 0 && run < 255)
+        {
+            run++;
+            i++;
+        }
+        out.push_back(0);
+        out.push_back(static_cast<std::uint8_t>(run));
+    }
+} // rleEncode function
+//----------------------------------------------------------------------------------------------------------------------
+// Undo rleEncode(); returns false if the input is cut short
+bool rleDecode(const std::uint8_t *in, std::size_t size, std::vector<std::uint8_t> &out)
+{
+    out.clear();
+    for (std::size_t i = 0; i < size; i++)
+    {
+        if (in[i] != 0)
+        {
+            out.push_back(in[i]);
+        }
+        else if (i + 1 < size)
+        {
+            out.insert(out.end(), in[++i], 0);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+} // rleDecode function
+//======================================================================================================================
+/**
+ * @struct SelfPlayRecord
+ * @brief One training example: a position, the search policy at it and the final result for the player to move.
+ */
+struct SelfPlayRecord
+{
+    float observation[ObservationEncoder::Size];
+    float policy[ActionCount];
+    int player;  // the player to move, whose view the observation is
+    int outcome; // +1 if player won the game, -1 if it lost, 0 if the game was cut off
+
+    /**
+     * @brief Appends the record in shard format: Size little-endian int16 observation values, the int8 outcome, a
+     * little-endian uint16 count of policy entries and then one (uint16 action, uint16 probability * 65535) pair per
+     * non-zero entry.
+     *
+     * The observation values are whole numbers; card ids + 1 reach CardNameIndex::MaxCards and hp and stats go
+     * negative, so they do not fit a byte. The run-length encoding of the shards packs the zero high bytes.
+     */
+    void serialize(std::vector<std::uint8_t> &out) const
+    {
+        for (int i = 0; i < ObservationEncoder::Size; i++)
+        {
+            const float v = observation[i];
+            const int q = static_cast<int>(v < -32768.0f ? -32768.0f : (v > 32767.0f ? 32767.0f : v));
+            out.push_back(static_cast<std::uint8_t>(q & 0xff));
+            out.push_back(static_cast<std::uint8_t>((q >> 8) & 0xff));
+        }
+        out.push_back(static_cast<std::uint8_t>(static_cast<std::int8_t>(outcome)));
+
+        const std::size_t countAt = out.size();
+        int count = 0;
+        out.push_back(0);
+        out.push_back(0);
+        for (int a = 0; a < ActionCount; a++)
+        {
+            if (policy[a] > 0.0f)
+            {
+                const int q = static_cast<int>(policy[a] * 65535.0f + 0.5f);
+                out.push_back(static_cast<std::uint8_t>(a & 0xff));
+                out.push_back(static_cast<std::uint8_t>(a >> 8));
+                out.push_back(static_cast<std::uint8_t>(q & 0xff));
+                out.push_back(static_cast<std::uint8_t>(q >> 8));
+                count++;
+            }
+        }
+        out[countAt] = static_cast<std::uint8_t>(count & 0xff);
+        out[countAt + 1] = static_cast<std::uint8_t>(count >> 8);
+    }
+}; // SelfPlayRecord struct
+static_assert(CardNameIndex::MaxCards < 32768, "card ids + 1 must fit the int16 observation values of the shards");
+//======================================================================================================================
+/**
+ * @class ShardWriter
+ * @brief Streams self-play records into size-capped binary shard files from a background thread.
+ *
+ * Simulation threads call write(), which serializes the record into a recycled buffer and queues it under a short
+ * lock; the writer thread does all compression and file output and hands the buffers back. The queue holds at most
+ * maxQueued records, so a disk that falls behind slows the simulation down instead of filling the memory. If a shard
+ * can not be created the writer reports it once and drops the records from then on; they are counted apart. A shard is named prefix-NNNNN.shard and starts with the 8-byte header
+ * "MGSH", uint16 version and uint16 flags (bit 0: records are rleEncode()d). Each record is a uint32 byte length and
+ * the (possibly compressed) SelfPlayRecord::serialize() bytes. When adding a record would pass the size cap the shard
+ * is closed with its footer: one uint64 file offset per record, the uint64 record count and "MGIX". A reader maps the
+ * file, reads the last 12 bytes and can then jump to any record. All integers are little-endian.
+ */
+class ShardWriter
+{
+public:
+    static constexpr std::uint16_t Version = 2;
+
+    /**
+     * @brief Starts the writer thread.
+     *
+     * @param prefix Path prefix of the shard files.
+     * @param maxShardBytes Size cap of one shard, footer included.
+     * @param compress Whether records are run-length encoded.
+     * @param maxQueued Records that can wait for the writer before write() blocks.
+     */
+    ShardWriter(const std::string &prefix, std::size_t maxShardBytes = 64 << 20, bool compress = true, std::size_t maxQueued = 4096)
+        : prefix(prefix), maxShardBytes(maxShardBytes), compress(compress), maxQueued(maxQueued > 0 ? maxQueued : 1)
+    {
+        worker = std::thread(&ShardWriter::run, this);
+    }
+
+    ShardWriter(const ShardWriter &) = delete;
+    ShardWriter &operator=(const ShardWriter &) = delete;
+
+    ~ShardWriter() { close(); }
+
+    /**
+     * @brief Writes everything still queued, closes the last shard and stops the thread; no record may be written
+     * afterwards. The destructor calls it too.
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_one();
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Queues a record; waits only while maxQueued records are already waiting.
+     */
+    void write(const SelfPlayRecord &record)
+    {
+        std::vector<std::uint8_t> bytes;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!spare.empty())
+            {
+                bytes = std::move(spare.back());
+                spare.pop_back();
+            }
+        }
+
+        bytes.clear(); // a recycled buffer keeps its capacity
+        record.serialize(bytes);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            drained.wait(lock, [this]()
+                         { return queue.size() < maxQueued; });
+            queue.push_back(std::move(bytes));
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * @brief Returns the number of records written to disk so far.
+     */
+    std::uint64_t getRecordsWritten() { return recordsWritten.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the number of records dropped because a shard could not be created.
+     */
+    std::uint64_t getRecordsDropped() { return recordsDropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the number of shard files started so far.
+     */
+    int getShardCount() { return shardCount.load(std::memory_order_relaxed); }
+
+private:
+    std::string prefix;
+    std::size_t maxShardBytes;
+    bool compress;
+    std::size_t maxQueued;
+    std::mutex mutex;
+    std::condition_variable ready;   // the queue has records or the writer is stopping
+    std::condition_variable drained; // the queue has room
+    std::deque<std::vector<std::uint8_t>> queue;
+    std::vector<std::vector<std::uint8_t>> spare; // written buffers for write() to reuse
+    bool stopping = false;
+    std::atomic<std::uint64_t> recordsWritten{0};
+    std::atomic<std::uint64_t> recordsDropped{0};
+    std::atomic<int> shardCount{0};
+
+    // owned by the writer thread
+    bool failed = false;
+    std::ofstream file;
+    std::uint64_t fileBytes = 0;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint8_t> packed;
+
+    std::thread worker;
+
+    static void putLittle(std::ofstream &out, std::uint64_t v, int bytes)
+    {
+        char b[8];
+        for (int i = 0; i < bytes; i++)
+        {
+            b[i] = static_cast<char>((v >> (8 * i)) & 0xff);
+        }
+        out.write(b, bytes);
+    }
+
+    bool openShard()
+    {
+        char name[16];
+        std::snprintf(name, sizeof(name), "-%05d.shard", shardCount.load(std::memory_order_relaxed));
+        file.open(prefix + name, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "could not open shard " << prefix + name << ", dropping the remaining records" << std::endl;
+            file.close();
+            failed = true;
+            return false;
+        }
+        shardCount.fetch_add(1, std::memory_order_relaxed);
+        file.write("MGSH", 4);
+        putLittle(file, Version, 2);
+        putLittle(file, compress ? 1 : 0, 2);
+        fileBytes = 8;
+        offsets.clear();
+        return true;
+    }
+
+    void closeShard()
+    {
+        for (std::uint64_t offset : offsets)
+        {
+            putLittle(file, offset, 8);
+        }
+        putLittle(file, offsets.size(), 8);
+        file.write("MGIX", 4);
+        file.close();
+    }
+
+    void append(const std::vector<std::uint8_t> &bytes)
+    {
+        if (failed)
+        {
+            recordsDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const std::vector<std::uint8_t> *payload = &bytes;
+        if (compress)
+        {
+            rleEncode(bytes.data(), bytes.size(), packed);
+            payload = &packed;
+        }
+
+        const std::uint64_t recordBytes = 4 + payload->size();
+        if (file.is_open() && !offsets.empty() && fileBytes + recordBytes + 8 * (offsets.size() + 1) + 12 > maxShardBytes)
+        {
+            closeShard();
+        }
+        if (!file.is_open() && !openShard())
+        {
+            recordsDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        offsets.push_back(fileBytes);
+        putLittle(file, payload->size(), 4);
+        file.write(reinterpret_cast<const char *>(payload->data()), static_cast<std::streamsize>(payload->size()));
+        fileBytes += recordBytes;
+        recordsWritten.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void run()
+    {
+        std::deque<std::vector<std::uint8_t>> batch;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]()
+                           { return stopping || !queue.empty(); });
+                if (queue.empty() && stopping)
+                {
+                    break;
+                }
+                batch.swap(queue);
+            }
+            drained.notify_all();
+            for (const auto &bytes : batch)
+            {
+                append(bytes);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &bytes : batch)
+            {
+                if (spare.size() < maxQueued)
+                {
+                    spare.push_back(std::move(bytes));
+                }
+            }
+            batch.clear();
+        }
+        if (file.is_open())
+        {
+            closeShard();
+        }
+    }
+}; // ShardWriter class
+//======================================================================================================================
+// Play self-play games claimed from nextGame until games are done; the body of one runSelfPlay() thread
+void selfPlayWorker(std::atomic<int> &nextGame, int games, int iterations, ShardWriter &writer, std::uint64_t seed, std::uint64_t rng, const QuantizedMlp *network,
+                    const std::string &replayPrefix)
+{
+    ParallelMcts search(1, 1 << 16);
+    std::vector<SelfPlayRecord> records;
+
+    search.setNetwork(network);
+    for (int g = nextGame.fetch_add(1); g < games; g = nextGame.fetch_add(1))
+    {
+        GameState s;
+        s.reset(seed + static_cast<std::uint64_t>(g));
+        ReplayLog replay(seed + static_cast<std::uint64_t>(g));
+        records.clear();
+
+        for (int step = 0; step < BatchEnv::MaxEpisodeSteps && !s.isOver(); step++)
+        {
+            const int player = s.toMove();
+            const CardTable &t = s.getCardTable();
+            const Determinizer view(s, player, t.decks[0], t.deckSizes[0], t.decks[1], t.deckSizes[1]);
+            GameState sample;
+
+            view.sample(sample, rng);
+            const Move move = search.chooseMove(sample, iterations);
+
+            records.emplace_back();
+            SelfPlayRecord &r = records.back();
+            ObservationEncoder::encode(s, player, r.observation, nullptr);
+            search.getRootPolicy(r.policy);
+            r.player = player;
+            if (!replayPrefix.empty())
+            {
+                replay.record(s, move);
+            }
+            s.applyMove(move);
+        }
+
+        if (!replayPrefix.empty())
+        {
+            char name[24];
+            std::snprintf(name, sizeof(name), "-%05d.mgrp", g);
+            replay.finish(s);
+            if (!replay.saveFile(replayPrefix + name))
+            {
+                std::cout << "replay log " << replayPrefix + name << " could not be written" << std::endl;
+            }
+        }
+
+        for (SelfPlayRecord &r : records)
+        {
+            r.outcome = !s.isOver() ? 0 : (s.winner == r.player ? 1 : -1);
+            writer.write(r);
+        }
+    }
+} // selfPlayWorker function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Plays AI-vs-AI games on several threads and streams one record per decision into a ShardWriter.
+ *
+ * Every decision is searched by a single-threaded ParallelMcts on a Determinizer sample for the player to move, so
+ * the search never sees hidden cards; the root visit shares are the policy target. The records of a game are held
+ * until the game ends and then sent with its outcome. Games that reach BatchEnv::MaxEpisodeSteps are written with
+ * outcome 0.
+ *
+ * @param games Number of games to play.
+ * @param iterations Search iterations per decision.
+ * @param writer Receives the records.
+ * @param seed Seed of the first game; game g uses seed + g.
+ * @param threadCount Number of simulation threads, 0 for one per hardware thread.
+ * @param network Optional value network for the searches.
+ * @param replayPrefix If not empty, game g is also saved as the ReplayLog replayPrefix-NNNNN.mgrp, NNNNN being g.
+ */
+void runSelfPlay(int games, int iterations, ShardWriter &writer, std::uint64_t seed = 1, int threadCount = 0, const QuantizedMlp *network = nullptr,
+                 const std::string &replayPrefix = "")
+{
+    if (threadCount <= 0)
+    {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<int> nextGame{0};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back(selfPlayWorker, std::ref(nextGame), games, iterations, std::ref(writer), seed, 0x9e3779b97f4a7c15ull * (t + 1) ^ seed, network,
+                             std::cref(replayPrefix));
+    }
+    for (auto &w : workers)
+    {
+        w.join();
+    }
+} // runSelfPlay function
+//======================================================================================================================
+/**
+ * @class CardDatabase
+ * @brief A card pool and its deck lists read from a text file, so new pools run without recompiling.
+ *
+ * The file is read line by line in one pass; '#' starts a comment. A card line is
+ *
+ *     card <name> <kind> <color> <white> <red> <green> <blue> <black> <generic> <attack> <hp> <keywords> <effect>
+ *          <effect attack> <effect hp>
+ *
+ * on one line, with the kind, color and effect spelled like the CardKind, CardColor and EffectKind enumerators, the
+ * five colored costs and the generic cost as numbers, keywords "-", "F" (first strike), "T" (trample) or "FT", and
+ * the amounts of the effect as the change it makes to the attack and hp of the creatures it hits: "LightningBolt 0 -2"
+ * deals 2 damage, "HolyWar 1 1" gives +1/+1 (see EffectKind). A deck line is
+ *
+ *     deck <deck name> <card name>[*count] ...
+ *
+ * and may only name cards defined above it; the decks named 1 and 2 are the ones GameState::reset() deals, any others
+ * are kept for tournament sweeps. Card ids are given in file order.
+ *
+ * Everything is checked while it is read: unique card and deck names of at most CardPrototype::MaxNameLength
+ * characters, known kinds, colors and effects, sensible stats, effects that fit the card kind, amounts that fit the
+ * effect, lands that make a real color, deck sizes within PlayerState::MaxLibrary, and decks 1 and 2 of exactly the deckSize of the format the pool
+ * is loaded for.
+ */
+class CardDatabase
+{
+public:
+    static constexpr int MaxCards = CardNameIndex::MaxCards; // the size of the name index; card ids are 16 bits
+
+    CardDatabase() = default;
+    CardDatabase(const CardDatabase &) = delete;            // the table points into this object
+    CardDatabase &operator=(const CardDatabase &) = delete;
+
+    /**
+     * @brief Reads a card pool from a file.
+     *
+     * @param path The file.
+     * @param gameRules The format the pool is played with; decks 1 and 2 must hold its deckSize cards.
+     * @return False (and the database is left empty) if the file can not be read or has an error, which is printed.
+     */
+    bool loadFile(const std::string &path, const GameRules &gameRules = StandardRules)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            std::cout << "card database " << path << " could not be opened" << std::endl;
+            return false;
+        }
+        return load(in, path, gameRules);
+    }
+
+    /**
+     * @brief Reads a card pool from a stream; name is only used in error messages.
+     */
+    bool load(std::istream &in, const std::string &name, const GameRules &gameRules = StandardRules)
+    {
+        std::string line;
+        int lineNumber = 0;
+
+        clear();
+        while (std::getline(in, line))
+        {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back(); // files saved with Windows line endings
+            }
+            const std::string error = parseLine(line.substr(0, line.find('#')));
+            if (!error.empty())
+            {
+                std::cout << "card database " << name << " line " << lineNumber << ": " << error << std::endl;
+                clear();
+                return false;
+            }
+        }
+        if (findDeck("1") < 0 || findDeck("2") < 0)
+        {
+            std::cout << "card database " << name << ": both deck 1 and deck 2 are needed" << std::endl;
+            clear();
+            return false;
+        }
+        for (const char *dealt : {"1", "2"})
+        {
+            const std::size_t cardCount = deckLists[findDeck(dealt)].size();
+            if (cardCount != static_cast<std::size_t>(gameRules.deckSize))
+            {
+                std::cout << "card database " << name << ": deck " << dealt << " holds " << cardCount << " cards, the format deals " << gameRules.deckSize
+                          << std::endl;
+                clear();
+                return false;
+            }
+        }
+
+        index = CardNameIndex(cards.data(), static_cast<int>(cards.size()));
+        if (!index.ready())
+        {
+            std::cout << "card database " << name << ": the card names can not be indexed" << std::endl;
+            clear();
+            return false;
+        }
+
+        const std::vector<CardId> &deck1 = deckLists[findDeck("1")];
+        const std::vector<CardId> &deck2 = deckLists[findDeck("2")];
+        view = CardTable{cards.data(), static_cast<int>(cards.size()), {deck1.data(), deck2.data()},
+                         {static_cast<int>(deck1.size()), static_cast<int>(deck2.size())}, &index};
+        return true;
+    }
+
+    /**
+     * @brief Returns the engine's view of the database, for useCardTable(); valid until the database is loaded again or
+     * destroyed.
+     */
+    const CardTable &table() const { return view; }
+
+    /**
+     * @brief Returns the id of the card with the given name, or -1.
+     */
+    int find(std::string_view cardName) const { return index.find(cardName, cards.data()); }
+
+    /**
+     * @brief Returns the index of the deck with the given name, or -1.
+     */
+    int findDeck(const std::string &deckName) const
+    {
+        const auto it = deckIds.find(deckName);
+        return it == deckIds.end() ? -1 : it->second;
+    }
+
+    const std::vector<CardPrototype> &getCards() const { return cards; }
+    int getDeckCount() const { return static_cast<int>(deckLists.size()); }
+    const std::string &getDeckName(int index) const { return deckNames[index]; }
+    const std::vector<CardId> &getDeck(int index) const { return deckLists[index]; }
+
+    static constexpr const char *KindNames[] = {"Land", "Creature", "Sorcery", "Enhancement"};
+    static constexpr const char *ColorNames[] = {"White", "Red", "Green", "Blue", "Black", "None"};
+    static constexpr const char *EffectNames[] = {"None", "Disenchant", "LightningBolt", "Flood", "Reanimate", "Plague", "Terror",
+                                                  "Rage", "HolyWar", "HolyLight", "UnholyWar", "Restrain", "Slow"};
+
+private:
+    std::vector<CardPrototype> cards;
+    std::unordered_map<std::string, CardId> ids; // while loading; find() uses the index
+    CardNameIndex index;
+    std::unordered_map<std::string, int> deckIds;
+    std::vector<std::string> deckNames;
+    std::vector<std::vector<CardId>> deckLists;
+    CardTable view = {nullptr, 0, {nullptr, nullptr}, {0, 0}, nullptr};
+
+    void clear()
+    {
+        cards.clear();
+        ids.clear();
+        deckIds.clear();
+        deckNames.clear();
+        deckLists.clear();
+        index = CardNameIndex();
+        view = CardTable{nullptr, 0, {nullptr, nullptr}, {0, 0}, nullptr};
+    }
+
+    // Index of word in a name list, or -1
+    template <std::size_t N>
+    static int indexOf(const char *const (&list)[N], const std::string &word)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            if (word == list[i])
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // Parse one line without its comment; returns an error message or an empty string
+    std::string parseLine(const std::string &line)
+    {
+        std::istringstream words(line);
+        std::string keyword;
+
+        if (!(words >> keyword))
+        {
+            return "";
+        }
+        if (keyword == "card")
+        {
+            return parseCard(words);
+        }
+        if (keyword == "deck")
+        {
+            return parseDeck(words);
+        }
+        return "unknown keyword " + keyword;
+    }
+
+    std::string parseCard(std::istringstream &words)
+    {
+        std::string name, kindName, colorName, keywords, effectName;
+        int cost[5], generic, attack, hp, effectAttack, effectHp;
+
+        if (!(words >> name >> kindName >> colorName >> cost[0] >> cost[1] >> cost[2] >> cost[3] >> cost[4] >> generic >> attack >> hp >> keywords >> effectName >>
+              effectAttack >> effectHp))
+        {
+            return "a card needs a name, kind, color, five colored costs, generic cost, attack, hp, keywords, effect and effect attack and hp";
+        }
+
+        const int kind = indexOf(KindNames, kindName);
+        const int color = indexOf(ColorNames, colorName);
+        const int effect = indexOf(EffectNames, effectName);
+        if (kind < 0 || color < 0 || effect < 0)
+        {
+            return "unknown " + std::string(kind < 0 ? "kind " + kindName : (color < 0 ? "color " + colorName : "effect " + effectName));
+        }
+        if (ids.count(name))
+        {
+            return "card " + name + " is defined twice";
+        }
+        if (name.size() > static_cast<std::size_t>(CardPrototype::MaxNameLength))
+        {
+            return "card name " + name + " is longer than " + std::to_string(CardPrototype::MaxNameLength) + " characters";
+        }
+        if (cards.size() >= static_cast<std::size_t>(MaxCards))
+        {
+            return "more than " + std::to_string(MaxCards) + " cards";
+        }
+        for (int c : {cost[0], cost[1], cost[2], cost[3], cost[4], generic})
+        {
+            if (c < 0 || c > 20)
+            {
+                return "costs must be between 0 and 20";
+            }
+        }
+        if (keywords != "-" && keywords != "F" && keywords != "T" && keywords != "FT")
+        {
+            return "keywords must be -, F, T or FT";
+        }
+
+        const CardKind k = static_cast<CardKind>(kind);
+        const EffectKind e = static_cast<EffectKind>(effect);
+        const bool sorceryEffect = e >= EffectKind::Disenchant && e <= EffectKind::Terror;
+        const bool enhancementEffect = e >= EffectKind::Rage;
+        if (k == CardKind::Creature ? attack < 0 || attack > 99 || hp < 1 || hp > 99 : attack != 0 || hp != 0 || keywords != "-")
+        {
+            return "only creatures have stats and keywords, with attack 0-99 and hp 1-99";
+        }
+        if ((k == CardKind::Sorcery && !sorceryEffect) || (k == CardKind::Enhancement && !enhancementEffect) ||
+            ((k == CardKind::Land || k == CardKind::Creature) && e != EffectKind::None))
+        {
+            return "effect " + effectName + " does not fit a " + kindName;
+        }
+        if (k == CardKind::Land && static_cast<CardColor>(color) == CardColor::None)
+        {
+            return "a land has to make a color of mana";
+        }
+        if (e == EffectKind::LightningBolt || e == EffectKind::Plague)
+        {
+            if (effectAttack != 0 || effectHp < -20 || effectHp > -1)
+            {
+                return "effect " + effectName + " deals 1 to 20 damage, written as effect attack 0 and effect hp -1 to -20";
+            }
+        }
+        else if (e == EffectKind::HolyWar || e == EffectKind::HolyLight || e == EffectKind::UnholyWar)
+        {
+            // small enough that every enchantment a player can hold stacked on a 99/99 creature still fits its int8 stats
+            if (effectAttack < -3 || effectAttack > 3 || effectHp < -3 || effectHp > 3)
+            {
+                return "effect " + effectName + " changes attack and hp by -3 to 3 each";
+            }
+        }
+        else if (effectAttack != 0 || effectHp != 0)
+        {
+            return "effect " + effectName + " has no amounts, they must be 0 0";
+        }
+
+        CardPrototype proto = {};
+        name.copy(proto.name, name.size());
+        proto.kind = k;
+        proto.color = static_cast<CardColor>(color);
+        for (int c = 0; c < 5; c++)
+        {
+            proto.cost[c] = static_cast<std::uint8_t>(cost[c]);
+        }
+        proto.generic = static_cast<std::uint8_t>(generic);
+        proto.attack = static_cast<std::int8_t>(attack);
+        proto.hp = static_cast<std::int8_t>(hp);
+        proto.firstStrike = keywords.find('F') != std::string::npos;
+        proto.trample = keywords.find('T') != std::string::npos;
+        proto.effect = e;
+        proto.effectAttack = static_cast<std::int8_t>(effectAttack);
+        proto.effectHp = static_cast<std::int8_t>(effectHp);
+
+        ids.emplace(name, static_cast<CardId>(cards.size()));
+        cards.push_back(proto);
+        return "";
+    }
+
+    std::string parseDeck(std::istringstream &words)
+    {
+        std::string deckName;
+        std::string entry;
+        std::vector<CardId> deck;
+
+        if (!(words >> deckName))
+        {
+            return "a deck line needs a deck name";
+        }
+        if (deckIds.count(deckName))
+        {
+            return "deck " + deckName + " is defined twice";
+        }
+        if (deckName.size() > static_cast<std::size_t>(CardPrototype::MaxNameLength))
+        {
+            return "deck name " + deckName + " is longer than " + std::to_string(CardPrototype::MaxNameLength) + " characters";
+        }
+        while (words >> entry)
+        {
+            const std::size_t star = entry.find('*');
+            const std::string name = entry.substr(0, star);
+            const int count = star == std::string::npos ? 1 : std::atoi(entry.c_str() + star + 1);
+            const auto id = ids.find(name);
+
+            if (id == ids.end())
+            {
+                return "deck names unknown card " + name;
+            }
+            if (count < 1 || deck.size() + count > static_cast<std::size_t>(PlayerState::MaxLibrary))
+            {
+                return "a deck holds 1 to " + std::to_string(PlayerState::MaxLibrary) + " cards";
+            }
+            deck.insert(deck.end(), count, id->second);
+        }
+        if (deck.empty())
+        {
+            return "deck " + deckName + " is empty";
+        }
+
+        deckIds.emplace(deckName, static_cast<int>(deckNames.size()));
+        deckNames.push_back(deckName);
+        deckLists.push_back(std::move(deck));
+        return "";
+    }
+}; // CardDatabase class
+//======================================================================================================================
+/**
+ * @class CardImage
+ * @brief A precompiled card pool mapped read-only into memory and used in place.
+ *
+ * compile() turns a CardDatabase into an image file; open() maps it with mmap, so starting a worker costs one
+ * system call and a header check, and every process that opens the same image shares its pages. The engine reads the
+ * CardPrototype records straight from the mapping.
+ *
+ * Layout, in the byte order of the machine that compiled it (the header records it): a Header, cardCount
+ * CardPrototype records, then (8-byte aligned) deckCount DeckRecord entries, the CardId lists of all decks back to
+ * back and a string table of NUL-terminated deck names. Card names live in the records themselves.
+ *
+ * On systems without mmap the image is read into memory instead.
+ *
+ * An image holds at most CardNameIndex::MaxCards (4096) cards, the most the name index built by open() takes. Card ids
+ * are 16 bits in the image, the serialized state and the observation encoding alike.
+ */
+class CardImage
+{
+public:
+    static constexpr std::uint32_t Version = 2;
+
+    /**
+     * @struct Header
+     * @brief The first bytes of an image.
+     */
+    struct Header
+    {
+        char magic[4]; // "MGCI"
+        std::uint32_t version;
+        std::uint32_t byteOrder;  // ByteOrderMark as written by the compiling machine
+        std::uint32_t recordSize; // sizeof(CardPrototype)
+        std::uint32_t cardCount;
+        std::uint32_t deckCount;
+        std::uint32_t defaultDecks[2]; // the decks GameState::reset() deals
+        std::uint64_t cardsOffset;
+        std::uint64_t decksOffset;
+        std::uint64_t deckCardsOffset;
+        std::uint64_t deckCardCount;
+        std::uint64_t stringsOffset;
+        std::uint64_t stringsSize;
+        std::uint64_t fileSize;
+    };
+
+    /**
+     * @struct DeckRecord
+     * @brief One deck list of an image.
+     */
+    struct DeckRecord
+    {
+        std::uint32_t name;      // offset in the string table
+        std::uint32_t firstCard; // index in the deck card array
+        std::uint32_t cardCount;
+        std::uint32_t reserved;
+    };
+
+    static constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+    CardImage() = default;
+    CardImage(const CardImage &) = delete;
+    CardImage &operator=(const CardImage &) = delete;
+    ~CardImage() { close(); }
+
+    /**
+     * @brief Writes the image of a card database.
+     *
+     * @return False if the file can not be written.
+     */
+    static bool compile(const CardDatabase &db, const std::string &path)
+    {
+        const std::vector<CardPrototype> &cards = db.getCards();
+        std::vector<DeckRecord> decks;
+        std::vector<CardId> deckCards;
+        std::string strings;
+
+        for (int d = 0; d < db.getDeckCount(); d++)
+        {
+            const std::vector<CardId> &list = db.getDeck(d);
+            decks.push_back(DeckRecord{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(deckCards.size()),
+                                       static_cast<std::uint32_t>(list.size()), 0});
+            deckCards.insert(deckCards.end(), list.begin(), list.end());
+            strings += db.getDeckName(d);
+            strings += '\0';
+        }
+
+        Header h = {};
+        std::memcpy(h.magic, "MGCI", 4);
+        h.version = Version;
+        h.byteOrder = ByteOrderMark;
+        h.recordSize = sizeof(CardPrototype);
+        h.cardCount = static_cast<std::uint32_t>(cards.size());
+        h.deckCount = static_cast<std::uint32_t>(decks.size());
+        h.defaultDecks[0] = static_cast<std::uint32_t>(db.findDeck("1"));
+        h.defaultDecks[1] = static_cast<std::uint32_t>(db.findDeck("2"));
+        h.cardsOffset = sizeof(Header);
+        h.decksOffset = align8(h.cardsOffset + cards.size() * sizeof(CardPrototype));
+        h.deckCardsOffset = h.decksOffset + decks.size() * sizeof(DeckRecord);
+        h.deckCardCount = deckCards.size();
+        h.stringsOffset = h.deckCardsOffset + deckCards.size() * sizeof(CardId);
+        h.stringsSize = strings.size();
+        h.fileSize = h.stringsOffset + strings.size();
+
+        std::vector<char> image(h.fileSize, 0);
+        std::memcpy(image.data(), &h, sizeof(Header));
+        std::memcpy(image.data() + h.cardsOffset, cards.data(), cards.size() * sizeof(CardPrototype));
+        std::memcpy(image.data() + h.decksOffset, decks.data(), decks.size() * sizeof(DeckRecord));
+        std::memcpy(image.data() + h.deckCardsOffset, deckCards.data(), deckCards.size() * sizeof(CardId));
+        std::memcpy(image.data() + h.stringsOffset, strings.data(), strings.size());
+
+        // Write a sibling file and rename it over the old image: a process that has the old one mapped keeps its pages,
+        // and a crash part way leaves either the old or the new image, never a torn one
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(image.data(), static_cast<std::streamsize>(image.size()));
+            out.flush();
+            if (!out)
+            {
+                out.close();
+                std::remove(temp.c_str());
+                return false;
+            }
+        }
+        if (std::rename(temp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Maps an image and checks it.
+     *
+     * @return False (and nothing stays mapped) if the file can not be mapped or is not a valid image for this build.
+     */
+    bool open(const std::string &path)
+    {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *mapped = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                base = static_cast<const std::uint8_t *>(mapped);
+                size = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        if (fd >= 0)
+        {
+            ::close(fd); // the mapping stays valid
+        }
+#else
+        std::ifstream in(path, std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        copy.assign((bytes.size() + 7) / 8, 0);
+        std::memcpy(copy.data(), bytes.data(), bytes.size());
+        base = reinterpret_cast<const std::uint8_t *>(copy.data());
+        size = bytes.size();
+#endif
+        if (!base || !validate())
+        {
+            std::cout << "card image " << path << " could not be mapped or is not valid" << std::endl;
+            close();
+            return false;
+        }
+
+        const Header &h = header();
+        const CardPrototype *cards = reinterpret_cast<const CardPrototype *>(base + h.cardsOffset);
+        index = CardNameIndex(cards, static_cast<int>(h.cardCount)); // a few microseconds, so it is not stored
+        if (!index.ready())
+        {
+            std::cout << "card image " << path << " has card names that can not be indexed" << std::endl;
+            close();
+            return false;
+        }
+
+        const DeckRecord &d1 = deckRecords()[h.defaultDecks[0]];
+        const DeckRecord &d2 = deckRecords()[h.defaultDecks[1]];
+        view = CardTable{cards, static_cast<int>(h.cardCount), {deckCards() + d1.firstCard, deckCards() + d2.firstCard},
+                         {static_cast<int>(d1.cardCount), static_cast<int>(d2.cardCount)}, &index};
+        return true;
+    }
+
+    /**
+     * @brief Unmaps the image; the table must not be in use any more.
+     */
+    void close()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (base)
+        {
+            munmap(const_cast<std::uint8_t *>(base), size);
+        }
+#else
+        copy.clear();
+#endif
+        base = nullptr;
+        size = 0;
+        index = CardNameIndex();
+        view = CardTable{nullptr, 0, {nullptr, nullptr}, {0, 0}, nullptr};
+    }
+
+    /**
+     * @brief Returns the engine's view of the image, for useCardTable().
+     */
+    const CardTable &table() const { return view; }
+
+    /**
+     * @brief Returns the id of the card with the given name, or -1.
+     */
+    int find(std::string_view cardName) const { return index.find(cardName, view.cards); }
+
+    int getDeckCount() const { return base ? static_cast<int>(header().deckCount) : 0; }
+
+    const char *getDeckName(int index) const { return reinterpret_cast<const char *>(base + header().stringsOffset) + deckRecords()[index].name; }
+
+    /**
+     * @brief Returns the cards of a deck, for GameState::reset() with explicit decks.
+     */
+    const CardId *getDeck(int index, int &count) const
+    {
+        count = static_cast<int>(deckRecords()[index].cardCount);
+        return deckCards() + deckRecords()[index].firstCard;
+    }
+
+private:
+    const std::uint8_t *base = nullptr;
+    std::size_t size = 0;
+    CardTable view = {nullptr, 0, {nullptr, nullptr}, {0, 0}, nullptr};
+    CardNameIndex index;
+#if !(defined(__unix__) || defined(__APPLE__))
+    std::vector<std::uint64_t> copy; // 8-byte aligned like a mapping
+#endif
+
+    static std::uint64_t align8(std::uint64_t v) { return (v + 7) & ~static_cast<std::uint64_t>(7); }
+
+    const Header &header() const { return *reinterpret_cast<const Header *>(base); }
+    const DeckRecord *deckRecords() const { return reinterpret_cast<const DeckRecord *>(base + header().decksOffset); }
+    const CardId *deckCards() const { return reinterpret_cast<const CardId *>(base + header().deckCardsOffset); }
+
+    // Check every offset and count against the file size, then the enum and bool bytes of the cards, the deck lists and
+    // the names, so nothing the engine reads from the mapping can be out of range
+    bool validate() const
+    {
+        if (size < sizeof(Header))
+        {
+            return false;
+        }
+
+        const Header &h = header();
+        // Bound the counts by the file size first, so the offset arithmetic below can not wrap
+        if (h.deckCount > size / sizeof(DeckRecord) || h.deckCardCount > size / sizeof(CardId) || h.stringsSize > size)
+        {
+            return false;
+        }
+        if (std::memcmp(h.magic, "MGCI", 4) != 0 || h.version != Version || h.byteOrder != ByteOrderMark || h.recordSize != sizeof(CardPrototype) ||
+            h.fileSize != size || h.cardCount > static_cast<std::uint32_t>(CardDatabase::MaxCards) || h.cardsOffset != sizeof(Header) ||
+            h.decksOffset != align8(h.cardsOffset + h.cardCount * sizeof(CardPrototype)) || h.deckCardsOffset != h.decksOffset + h.deckCount * sizeof(DeckRecord) ||
+            h.stringsOffset != h.deckCardsOffset + h.deckCardCount * sizeof(CardId) || h.stringsOffset + h.stringsSize != size ||
+            h.defaultDecks[0] >= h.deckCount || h.defaultDecks[1] >= h.deckCount || (h.stringsSize > 0 && base[size - 1] != 0))
+        {
+            return false;
+        }
+
+        const CardPrototype *cards = reinterpret_cast<const CardPrototype *>(base + h.cardsOffset);
+        for (std::uint32_t c = 0; c < h.cardCount; c++)
+        {
+            const CardPrototype &p = cards[c];
+            std::uint8_t flags[2];
+            std::memcpy(flags, &p.firstStrike, 1);
+            std::memcpy(flags + 1, &p.trample, 1);
+            if (p.name[0] == 0 || p.name[CardPrototype::MaxNameLength] != 0 || static_cast<std::size_t>(p.kind) >= std::size(CardDatabase::KindNames) ||
+                static_cast<std::size_t>(p.color) >= std::size(CardDatabase::ColorNames) ||
+                static_cast<std::size_t>(p.effect) >= std::size(CardDatabase::EffectNames) || flags[0] > 1 || flags[1] > 1)
+            {
+                return false;
+            }
+        }
+
+        for (std::uint32_t d = 0; d < h.deckCount; d++)
+        {
+            const DeckRecord &r = deckRecords()[d];
+            if (r.cardCount < 1 || r.cardCount > static_cast<std::uint32_t>(PlayerState::MaxLibrary) || r.firstCard > h.deckCardCount ||
+                r.cardCount > h.deckCardCount - r.firstCard || r.name >= h.stringsSize)
+            {
+                return false;
+            }
+        }
+
+        const CardId *ids = deckCards();
+        for (std::uint64_t i = 0; i < h.deckCardCount; i++)
+        {
+            if (ids[i] >= h.cardCount)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}; // CardImage class
+//======================================================================================================================
+/**
+ * @class CardTableLease
+ * @brief A game's hold on one published card pool of a CardTableRegistry.
+ *
+ * A game is dealt with table() and the pool stays valid until the lease is released or destroyed, whatever the
+ * registry publishes meanwhile. Copies of the game share the lease's pool, so the lease should live as long as the
+ * game and all its copies (searches included).
+ */
+class CardTableLease
+{
+public:
+    CardTableLease() = default;
+    CardTableLease(const CardTableLease &) = delete;
+    CardTableLease &operator=(const CardTableLease &) = delete;
+    CardTableLease(CardTableLease &&other) noexcept { *this = std::move(other); }
+    ~CardTableLease() { release(); }
+
+    CardTableLease &operator=(CardTableLease &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            slot = other.slot;
+            cardTable = other.cardTable;
+            version = other.version;
+            other.slot = nullptr;
+            other.cardTable = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Returns the leased pool, for GameState::reset().
+     */
+    const CardTable &table() const { return *cardTable; }
+
+    /**
+     * @brief Returns the number of the publication the pool came from; the registry starts at 0.
+     */
+    std::uint64_t getVersion() const { return version; }
+
+    /**
+     * @brief Lets the registry free the pool once no other lease needs it; the game must not be used afterwards.
+     */
+    void release()
+    {
+        if (slot)
+        {
+            slot->store(FreeSlot);
+            slot = nullptr;
+            cardTable = nullptr;
+        }
+    }
+
+private:
+    friend class CardTableRegistry;
+
+    static constexpr std::uint64_t FreeSlot = ~static_cast<std::uint64_t>(0);
+
+    std::atomic<std::uint64_t> *slot = nullptr; // holds the epoch the lease was taken in
+    const CardTable *cardTable = nullptr;
+    std::uint64_t version = 0;
+}; // CardTableLease class
+//======================================================================================================================
+/**
+ * @class CardTableRegistry
+ * @brief Publishes the card pool of a long-running server and replaces it without stopping the games.
+ *
+ * Game threads call acquire() when a game starts; taking and releasing a lease is a compare-and-swap and a store on a
+ * fixed slot array, so they never lock. A reload (reload(), publish() or a SIGHUP, see poll()) swaps in a new
+ * immutable pool: games already running keep their old one and new games get the new one.
+ *
+ * Old pools are freed with epoch-based reclamation. Each publication advances the epoch and retires the replaced pool
+ * with the epoch it was current in; every lease holds the epoch it was taken in. collect() frees a retired pool once
+ * no lease taken in or before its epoch is left, because only those leases can point at it. The publishing side is
+ * serialized by a mutex that game threads never touch.
+ */
+class CardTableRegistry
+{
+public:
+    static constexpr int MaxLeases = 4096;
+
+    /**
+     * @brief Starts with the built-in card pool as version 0.
+     */
+    CardTableRegistry()
+    {
+        for (std::atomic<std::uint64_t> &s : slots)
+        {
+            s.store(CardTableLease::FreeSlot);
+        }
+        current.store(new Snapshot{nullptr, nullptr, &BuiltinCardTable, 0, 0});
+    }
+
+    CardTableRegistry(const CardTableRegistry &) = delete;
+    CardTableRegistry &operator=(const CardTableRegistry &) = delete;
+
+    /**
+     * @brief Frees every pool; no lease may be left.
+     */
+    ~CardTableRegistry()
+    {
+        delete current.load();
+        for (Snapshot *s : retired)
+        {
+            delete s;
+        }
+    }
+
+    /**
+     * @brief Leases the current pool for a new game.
+     *
+     * If all MaxLeases slots are taken the caller yields until one is released.
+     */
+    CardTableLease acquire()
+    {
+        CardTableLease lease;
+        for (unsigned i = nextSlot.fetch_add(1, std::memory_order_relaxed);; i++)
+        {
+            std::atomic<std::uint64_t> &s = slots[i % MaxLeases];
+            std::uint64_t expected = CardTableLease::FreeSlot;
+            if (s.load(std::memory_order_relaxed) == expected && s.compare_exchange_strong(expected, epoch.load()))
+            {
+                // the epoch is pinned before the pool is read, so a pool this lease can see is never freed under it
+                const Snapshot *snapshot = current.load();
+                lease.slot = &s;
+                lease.cardTable = snapshot->table;
+                lease.version = snapshot->version;
+                return lease;
+            }
+            if (i % MaxLeases == MaxLeases - 1)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief Makes a loaded card database the pool of new games.
+     */
+    void publish(std::unique_ptr<CardDatabase> database)
+    {
+        const CardTable *table = &database->table();
+        publish(new Snapshot{std::move(database), nullptr, table, 0, 0});
+    }
+
+    /**
+     * @brief Makes an opened card image the pool of new games.
+     */
+    void publish(std::unique_ptr<CardImage> image)
+    {
+        const CardTable *table = &image->table();
+        publish(new Snapshot{nullptr, std::move(image), table, 0, 0});
+    }
+
+    /**
+     * @brief Loads a card database text file or a compiled card image and publishes it.
+     *
+     * @return False (and the current pool stays) if the file can not be loaded.
+     */
+    bool reload(const std::string &path)
+    {
+        char magic[4] = {};
+        std::ifstream(path, std::ios::binary).read(magic, 4);
+
+        if (std::memcmp(magic, "MGCI", 4) == 0)
+        {
+            std::unique_ptr<CardImage> image(new CardImage());
+            if (!image->open(path))
+            {
+                return false;
+            }
+            publish(std::move(image));
+        }
+        else
+        {
+            std::unique_ptr<CardDatabase> database(new CardDatabase());
+            if (!database->loadFile(path))
+            {
+                return false;
+            }
+            publish(std::move(database));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reloads path if a reload signal arrived since the last call; for the server's control loop.
+     *
+     * @return True if a new pool was published.
+     */
+    bool poll(const std::string &path) { return reloadRequested.exchange(false) && reload(path); }
+
+    /**
+     * @brief Makes SIGHUP request a reload that the next poll() carries out; the handler only sets a flag.
+     */
+    static void installReloadSignal()
+    {
+#ifdef SIGHUP
+        std::signal(SIGHUP, [](int) { reloadRequested.store(true); });
+#endif
+    }
+
+    /**
+     * @brief Frees the retired pools no lease can reach any more.
+     *
+     * @return The number of retired pools still waiting for their games to end.
+     */
+    int collect()
+    {
+        std::lock_guard<std::mutex> lock(control);
+        return collectLocked();
+    }
+
+    /**
+     * @brief Returns the version of the pool new games get.
+     */
+    std::uint64_t getVersion() const { return current.load()->version; }
+
+private:
+    /**
+     * @struct Snapshot
+     * @brief A published pool and the storage that owns it.
+     */
+    struct Snapshot
+    {
+        std::unique_ptr<CardDatabase> database;
+        std::unique_ptr<CardImage> image;
+        const CardTable *table;
+        std::uint64_t version;
+        std::uint64_t retiredIn; // epoch in which it stopped being current
+    }; // Snapshot struct
+
+    inline static std::atomic<bool> reloadRequested{false};
+
+    std::atomic<std::uint64_t> slots[MaxLeases];
+    std::atomic<unsigned> nextSlot{0};
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<Snapshot *> current{nullptr};
+    std::mutex control;              // publishers only
+    std::vector<Snapshot *> retired; // guarded by control
+
+    void publish(Snapshot *next)
+    {
+        std::lock_guard<std::mutex> lock(control);
+        next->version = current.load()->version + 1;
+        Snapshot *old = current.exchange(next);
+        old->retiredIn = epoch.fetch_add(1);
+        retired.push_back(old);
+        collectLocked();
+    }
+
+    int collectLocked()
+    {
+        std::uint64_t oldest = CardTableLease::FreeSlot;
+        for (const std::atomic<std::uint64_t> &s : slots)
+        {
+            const std::uint64_t pinned = s.load();
+            oldest = pinned < oldest ? pinned : oldest;
+        }
+
+        std::size_t kept = 0;
+        for (Snapshot *s : retired)
+        {
+            if (s->retiredIn < oldest)
+            {
+                delete s;
+            }
+            else
+            {
+                retired[kept++] = s;
+            }
+        }
+        retired.resize(kept);
+        return static_cast<int>(kept);
+    }
+}; // CardTableRegistry class
+//======================================================================================================================
+/**
+ * @brief Compiles a card database text file into a card image: --compile-cards <database> <image>.
+ *
+ * @return The process exit code.
+ */
+int compileCardsCommand(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        std::cout << "usage: " << argv[0] << " --compile-cards <database> <image>" << std::endl;
+        return 2;
+    }
+
+    CardDatabase database;
+    if (!database.loadFile(argv[2]))
+    {
+        return 1;
+    }
+    if (!CardImage::compile(database, argv[3]))
+    {
+        std::cout << "card image " << argv[3] << " could not be written" << std::endl;
+        return 1;
+    }
+
+    CardImage image; // read it back, so a bad image is caught here and not in the workers
+    if (!image.open(argv[3]))
+    {
+        return 1;
+    }
+    std::cout << "compiled " << image.table().cardCount << " cards and " << image.getDeckCount() << " decks into " << argv[3] << std::endl;
+    return 0;
+} // compileCardsCommand function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Plays random games on every hardware thread from a CardTableRegistry and reloads the card pool on SIGHUP:
+ * --serve-cards <pool> [seconds]. The pool is a card database or a card image; without seconds it runs until killed.
+ *
+ * @return The process exit code.
+ */
+int serveCardsCommand(int argc, char **argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        std::cout << "usage: " << argv[0] << " --serve-cards <pool> [seconds]" << std::endl;
+        return 2;
+    }
+
+    const std::string path = argv[2];
+    const int seconds = argc == 4 ? std::atoi(argv[3]) : 0;
+    CardTableRegistry registry;
+    CardTableRegistry::installReloadSignal();
+    if (!registry.reload(path))
+    {
+        return 1;
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> games{0};
+    auto work = [&registry, &stop, &games](std::uint64_t seed)
+    {
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            CardTableLease lease = registry.acquire(); // held until the game is over
+            GameState s;
+            s.reset(seed, lease.table());
+            randomPlayout(s, seed);
+            games.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::max(1u, std::thread::hardware_concurrency()); t++)
+    {
+        workers.emplace_back(work, 0x9e3779b97f4a7c15ull * (t + 1));
+    }
+
+    std::cout << "serving card pool " << path << " as version " << registry.getVersion() << ", send SIGHUP to reload it" << std::endl;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (seconds <= 0 || std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (registry.poll(path))
+        {
+            std::cout << "reloaded " << path << " as version " << registry.getVersion() << " after " << games.load() << " games" << std::endl;
+        }
+        registry.collect();
+    }
+
+    stop.store(true);
+    for (std::thread &w : workers)
+    {
+        w.join();
+    }
+    std::cout << games.load() << " games played, " << registry.collect() << " retired pools left" << std::endl;
+    return 0;
+} // serveCardsCommand function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Plays AI-vs-AI games into training shards: --self-play <prefix> <games> [iterations] [threads] [seed] [replays].
+ * With a replays prefix every game is also saved as a replay log that replayGame() re-checks.
+ *
+ * @return The process exit code.
+ */
+int selfPlayCommand(int argc, char **argv)
+{
+    if (argc < 4 || argc > 8)
+    {
+        std::cout << "usage: " << argv[0] << " --self-play <prefix> <games> [iterations] [threads] [seed] [replays]" << std::endl;
+        return 2;
+    }
+
+    const int games = std::atoi(argv[3]);
+    const int iterations = argc > 4 ? std::atoi(argv[4]) : 200;
+    const int threads = argc > 5 ? std::atoi(argv[5]) : 0;
+    const std::uint64_t seed = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : 1;
+    const std::string replayPrefix = argc > 7 ? argv[7] : "";
+    if (games < 1 || iterations < 1)
+    {
+        std::cout << "games and iterations must be positive" << std::endl;
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    ShardWriter writer(argv[2]);
+    runSelfPlay(games, iterations, writer, seed, threads, nullptr, replayPrefix);
+    writer.close();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << games << " games, " << writer.getRecordsWritten() << " records in " << writer.getShardCount() << " shards, "
+              << seconds << " s" << std::endl;
+    if (writer.getRecordsDropped() > 0)
+    {
+        std::cout << writer.getRecordsDropped() << " records were dropped" << std::endl;
+        return 1;
+    }
+    return 0;
+} // selfPlayCommand function
+//----------------------------------------------------------------------------------------------------------------------
+// The card classes as they were before Card became a tagged value type: a virtual method per operation, empty in the
+// kinds it does not apply to, with owned strings and every card behind a shared_ptr. --bench-cards times the zone
+// sweeps of the interactive game over these against the same sweeps over Card
+class VirtualCard
+{
+protected:
+    std::string cardName, cardType, cardColor;
+
+public:
+    VirtualCard(std::string_view cN, std::string_view tP, std::string_view c) : cardName(cN), cardType(tP), cardColor(c) {}
+    virtual ~VirtualCard() = default;
+
+    virtual void setUntapped() {}
+    virtual void goBaseHp() {}
+    virtual void changeStats(int, int) {}
+    virtual void sustainDamage(int) {}
+    virtual int getHp() { return 0; }
+    virtual int getAttackPower() { return 0; }
+    virtual bool checkDead() { return false; }
+}; // VirtualCard class
+
+class VirtualLandCard : public VirtualCard
+{
+    bool hasTapped = false;
+
+public:
+    using VirtualCard::VirtualCard;
+    void setUntapped() override { hasTapped = false; }
+}; // VirtualLandCard class
+
+class VirtualCreatureCard : public VirtualCard
+{
+    int attackPower, baseHP, hp;
+    bool hasTapped = false;
+
+public:
+    VirtualCreatureCard(std::string_view cN, std::string_view tP, std::string_view c, int attack, int hpValue)
+        : VirtualCard(cN, tP, c), attackPower(attack), baseHP(hpValue), hp(hpValue) {}
+    void setUntapped() override { hasTapped = false; }
+    void goBaseHp() override { hp = baseHP; }
+    void changeStats(int attack, int hpChange) override
+    {
+        attackPower += attack;
+        hp += hpChange;
+    }
+    void sustainDamage(int dmg) override { hp -= dmg; }
+    int getHp() override { return hp; }
+    int getAttackPower() override { return attackPower; }
+    bool checkDead() override { return hp < 1; }
+}; // VirtualCreatureCard class
+
+class VirtualSpellCard : public VirtualCard
+{
+    std::string manaCost, effect;
+
+public:
+    using VirtualCard::VirtualCard;
+}; // VirtualSpellCard class
+//----------------------------------------------------------------------------------------------------------------------
+// One turn's worth of per-card work: untapped(), baseHp(), a stat change and its reversal, a point of damage and the
+// reads of combat. C is Card or std::shared_ptr<VirtualCard>; benchCard() lets both go through the same code
+inline Card &benchCard(Card &card) { return card; }
+inline VirtualCard &benchCard(std::shared_ptr<VirtualCard> &card) { return *card; }
+
+template <typename C>
+long long sweepCards(std::vector<C> &cards)
+{
+    long long sum = 0;
+    for (C &c : cards)
+    {
+        benchCard(c).setUntapped();
+    }
+    for (C &c : cards)
+    {
+        benchCard(c).goBaseHp();
+    }
+    for (C &c : cards)
+    {
+        benchCard(c).changeStats(1, 1);
+        benchCard(c).sustainDamage(1);
+        benchCard(c).changeStats(-1, -1);
+        sum += benchCard(c).getHp() + benchCard(c).getAttackPower() + benchCard(c).checkDead();
+    }
+    return sum;
+} // sweepCards function
+
+// Best time of a few rounds of sweeps over cards, in ns per sweep; checksum gets the sum of every sweep
+template <typename C>
+double timeSweeps(std::vector<C> &cards, int sweeps, long long &checksum)
+{
+    double best = 0.0;
+    for (int round = 0; round < 5; round++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < sweeps; i++)
+        {
+            checksum += sweepCards(cards);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / sweeps;
+        best = round == 0 || ns < best ? ns : best;
+    }
+    return best;
+} // timeSweeps function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Times the zone sweeps over the two built-in decks as Card values and as the old virtual hierarchy:
+ * --bench-cards [sweeps].
+ *
+ * @return The process exit code; 1 if the two representations disagree on the sweep results.
+ */
+int benchCardsCommand(int argc, char **argv)
+{
+    if (argc > 3)
+    {
+        std::cout << "usage: " << argv[0] << " --bench-cards [sweeps]" << std::endl;
+        return 2;
+    }
+    const int sweeps = argc > 2 ? std::atoi(argv[2]) : 200000;
+    if (sweeps < 1)
+    {
+        std::cout << "sweeps must be positive" << std::endl;
+        return 2;
+    }
+
+    static const char *const TypeNames[] = {"LandCard", "CreatureCard", "SorceryCard", "EnhancementCard"}; // CardKind order
+    std::vector<Card> values;
+    std::vector<std::shared_ptr<VirtualCard>> pointers;
+    for (int d = 0; d < 2; d++)
+    {
+        for (int i = 0; i < BuiltinCardTable.deckSizes[d]; i++)
+        {
+            const CardPrototype &proto = BuiltinCardTable.cards[BuiltinCardTable.decks[d][i]];
+            const char *type = TypeNames[static_cast<int>(proto.kind)];
+            values.push_back(Card::fromPrototype(proto));
+            switch (proto.kind)
+            {
+            case CardKind::Land:
+                pointers.push_back(std::make_shared<VirtualLandCard>(proto.name, type, " "));
+                break;
+            case CardKind::Creature:
+                pointers.push_back(std::make_shared<VirtualCreatureCard>(proto.name, type, CardDatabase::ColorNames[static_cast<int>(proto.color)],
+                                                                         proto.attack, proto.hp));
+                break;
+            default:
+                pointers.push_back(std::make_shared<VirtualSpellCard>(proto.name, type, CardDatabase::ColorNames[static_cast<int>(proto.color)]));
+                break;
+            }
+        }
+    }
+
+    long long valueSum = 0;
+    long long virtualSum = 0;
+    const double virtualNs = timeSweeps(pointers, sweeps, virtualSum);
+    const double valueNs = timeSweeps(values, sweeps, valueSum);
+
+    std::cout << values.size() << " cards, best of 5 rounds of " << sweeps << " sweeps" << std::endl
+              << "virtual hierarchy: " << virtualNs << " ns per sweep" << std::endl
+              << "tagged value type: " << valueNs << " ns per sweep (" << virtualNs / valueNs << "x faster)" << std::endl;
+    if (valueSum != virtualSum)
+    {
+        std::cout << "the two card representations disagree: " << valueSum << " != " << virtualSum << std::endl;
+        return 1;
+    }
+    return 0;
+} // benchCardsCommand function
+//----------------------------------------------------------------------------------------------------------------------
+// Behavior checks of the headless engine run by --selftest; each returns nullptr or what went wrong
+
+// Play up to count moves picked like a playout, recording them in log if there is one
+void playRandomMoves(GameState &s, std::uint64_t &rng, int count, ReplayLog *log)
+{
+    Move moves[GameState::MaxMoves];
+
+    for (int i = 0; i < count && !s.isOver(); i++)
+    {
+        const int n = s.generateMoves(moves);
+        const Move m = moves[playoutMoveIndex(n, rng)];
+        if (log != nullptr)
+        {
+            log->record(s, m);
+        }
+        s.applyMove(m);
+    }
+} // playRandomMoves function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkEndgameMate()
+{
+    // two 3/3 attackers against one blocker and 3 hp: whatever is blocked, the other one kills
+    GameState s;
+    s.reset(1);
+    const int hobgoblin = findCard("Hobgoblin", s.getCardTable());
+    if (hobgoblin < 0)
+    {
+        return "the active card pool has no Hobgoblin";
+    }
+
+    PlayerState &me = s.players[s.active];
+    PlayerState &op = s.players[1 - s.active];
+    me.hand.clear();
+    op.hand.clear();
+    me.creatureCount = 2;
+    op.creatureCount = 1;
+    for (int c = 0; c < 2; c++)
+    {
+        me.creatures[c] = CreatureSlot{static_cast<CardId>(hobgoblin), 3, 3, 3, false, false, false};
+    }
+    op.creatures[0] = CreatureSlot{static_cast<CardId>(hobgoblin), 3, 3, 3, false, false, false};
+    op.hp = 3;
+
+    // a round trip through the state format rebuilds the zone hashes of the edited zones
+    std::uint8_t bytes[MaxSerializedStateBytes];
+    GameState position;
+    if (deserializeState(bytes, static_cast<std::size_t>(serializeState(s, bytes)), position, s.getCardTable()) == 0)
+    {
+        return "the mate position does not pass deserializeState";
+    }
+
+    EndgameSolver solver(16);
+    const SolveResult r = solver.solve(position, 1000000, 16);
+    if (!r.proven || r.winner != position.active)
+    {
+        return "the solver does not prove the win of the player to move";
+    }
+    return nullptr;
+} // checkEndgameMate function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkAiPlayerMoves()
+{
+    // the bot plays one side of a whole game against random moves; every answer must be legal where it is given
+    const int maxSteps = 2000; // games that run longer are cut off
+    AiPlayer bot(1.0, 2);
+    GameState s;
+    Move moves[GameState::MaxMoves];
+    std::uint64_t rng = 3;
+
+    s.reset(3);
+    for (int step = 0; step < maxSteps && !s.isOver(); step++)
+    {
+        const int n = s.generateMoves(moves);
+        const Move m = s.toMove() == 0 ? bot.decide(s) : moves[playoutMoveIndex(n, rng)];
+        if (std::find(moves, moves + n, m) == moves + n)
+        {
+            return "the bot answers with a move that is not legal";
+        }
+        s.applyMove(m);
+    }
+    return nullptr;
+} // checkAiPlayerMoves function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkBatchEnvDeterminism()
+{
+    // 1024 games give the threaded environment several workers; both must step exactly alike
+    const int envCount = 1024;
+    BatchEnv single(envCount, 5, 1);
+    BatchEnv threaded(envCount, 5, 4);
+    std::vector<int> actions(envCount);
+    std::uint64_t rng = 5;
+
+    for (int step = 0; step < 200; step++)
+    {
+        for (int i = 0; i < envCount; i++)
+        {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            actions[i] = static_cast<int>(rng % ActionCount); // mostly illegal, which exercises the fallback too
+        }
+        single.step(actions.data());
+        threaded.step(actions.data());
+
+        const std::size_t observationBytes = static_cast<std::size_t>(envCount) * BatchEnv::ObservationSize * sizeof(float);
+        if (std::memcmp(single.observations(), threaded.observations(), observationBytes) != 0 ||
+            std::memcmp(single.rewards(), threaded.rewards(), envCount * sizeof(float)) != 0 ||
+            std::memcmp(single.dones(), threaded.dones(), envCount) != 0)
+        {
+            return "one and four threads step the same games differently";
+        }
+    }
+    return nullptr;
+} // checkBatchEnvDeterminism function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkStateRoundTrip()
+{
+    GameState s;
+    std::uint64_t rng = 7;
+    s.reset(7);
+
+    while (!s.isOver())
+    {
+        std::uint8_t bytes[MaxSerializedStateBytes];
+        std::uint8_t again[MaxSerializedStateBytes];
+        GameState copy;
+        const int size = serializeState(s, bytes);
+
+        if (deserializeState(bytes, static_cast<std::size_t>(size), copy, s.getCardTable()) != size)
+        {
+            return "a serialized state is not read back";
+        }
+        if (copy.hash() != s.hash() || serializeState(copy, again) != size || std::memcmp(bytes, again, static_cast<std::size_t>(size)) != 0)
+        {
+            return "a state read back differs from the one written";
+        }
+        if (deserializeState(bytes, static_cast<std::size_t>(size - 1), copy, s.getCardTable()) != 0)
+        {
+            return "a truncated state is accepted";
+        }
+        playRandomMoves(s, rng, 1, nullptr);
+    }
+    return nullptr;
+} // checkStateRoundTrip function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkReplay()
+{
+    GameState s;
+    ReplayLog log(11, 2);
+    std::unordered_map<int, std::uint64_t> turnStarts; // hash at the first decision point of every turn
+    std::uint64_t rng = 11;
+
+    s.reset(11);
+    while (!s.isOver() && s.turn < 200)
+    {
+        turnStarts.emplace(s.turn, s.hash());
+        playRandomMoves(s, rng, 1, &log);
+    }
+    log.finish(s);
+
+    std::vector<std::uint8_t> bytes;
+    ReplayLog loaded;
+    log.save(bytes);
+    if (!loaded.load(bytes.data(), bytes.size()))
+    {
+        return "a saved replay log is not read back";
+    }
+
+    const ReplayResult r = replayGame(loaded);
+    if (!r.ok || r.state.hash() != s.hash())
+    {
+        return "the replay does not end in the live game's state";
+    }
+    for (const auto &start : turnStarts)
+    {
+        GameState seek;
+        if (!seekTurn(loaded, start.first, seek) || seek.hash() != start.second)
+        {
+            return "seekTurn does not rebuild the start of a turn";
+        }
+    }
+    if (verifyReplayParallel(loaded, 4) != -1)
+    {
+        return "verifyReplayParallel rejects a good log";
+    }
+    return nullptr;
+} // checkReplay function
+//----------------------------------------------------------------------------------------------------------------------
+// A pool with the built-in deck size: a land, a trampling creature and a bolt that hits harder than the built-in one
+const char *const SelfTestPool = "card Forest Land Green 0 0 0 0 0 0 0 0 - None 0 0\n"
+                                 "card AngryBear Creature Green 0 0 1 0 0 2 3 2 T None 0 0\n"
+                                 "card LightningBolt Sorcery Green 0 0 1 0 0 1 0 0 - LightningBolt 0 -3\n"
+                                 "deck 1 Forest*13 AngryBear*11 LightningBolt*2\n"
+                                 "deck 2 Forest*13 AngryBear*13\n";
+
+const char *checkCardDatabase()
+{
+    CardDatabase database;
+    std::istringstream pool(SelfTestPool);
+    if (!database.load(pool, "self-test pool"))
+    {
+        return "a valid card database is rejected";
+    }
+
+    const CardTable table = database.table();
+    const int bear = database.find("AngryBear");
+    const int bolt = database.find("LightningBolt");
+    if (table.cardCount != 3 || bear < 0 || table.cards[bear].attack != 3 || table.cards[bear].hp != 2 || !table.cards[bear].trample || bolt < 0 ||
+        table.cards[bolt].effectHp != -3 || table.deckSizes[0] != BuiltinDeckSize || table.deckSizes[1] != BuiltinDeckSize)
+    {
+        return "the card database does not hold the cards and decks it was given";
+    }
+
+    // the bolt deals the damage of the pool, not the built-in 2
+    bool boltCast = false;
+    std::uint64_t rng = 7;
+    for (std::uint64_t seed = 7; seed < 27 && !boltCast; seed++)
+    {
+        GameState s;
+        s.reset(seed, table);
+        while (!s.isOver() && !boltCast)
+        {
+            Move moves[GameState::MaxMoves];
+            const int n = s.generateMoves(moves);
+            for (int i = 0; i < n && !boltCast; i++)
+            {
+                const PlayerState &me = s.players[s.active];
+                if (moves[i].kind == MoveKind::PlayCard && moves[i].target == Move::TargetPlayer && me.hand[moves[i].slot] == bolt)
+                {
+                    const int hp = s.players[1 - s.active].hp;
+                    const int opponent = 1 - s.active;
+                    s.applyMove(moves[i]);
+                    if (s.players[opponent].hp != hp - 3)
+                    {
+                        return "a LightningBolt does not deal the damage of its pool";
+                    }
+                    boltCast = true;
+                }
+            }
+            playRandomMoves(s, rng, 1, nullptr);
+        }
+    }
+    if (!boltCast)
+    {
+        return "no game of the self-test pool casts its LightningBolt";
+    }
+
+    std::istringstream shortDeck("card Forest Land Green 0 0 0 0 0 0 0 0 - None 0 0\ndeck 1 Forest*25\ndeck 2 Forest*26\n");
+    if (database.load(shortDeck, "self-test pool with a short deck (this error is expected)"))
+    {
+        return "a deck with the wrong size is accepted";
+    }
+    std::istringstream landAmounts("card Forest Land Green 0 0 0 0 0 0 0 0 - None 0 -2\n");
+    if (database.load(landAmounts, "self-test pool with effect amounts on a land (this error is expected)"))
+    {
+        return "effect amounts on a card without an effect are accepted";
+    }
+    return nullptr;
+} // checkCardDatabase function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkCardImage()
+{
+    CardDatabase database;
+    std::istringstream pool(SelfTestPool);
+    if (!database.load(pool, "self-test pool"))
+    {
+        return "the self-test pool is rejected";
+    }
+
+    const std::string path = std::string(P_tmpdir) + "/cards-selftest-" + std::to_string(getpid()) + ".img";
+    CardImage image;
+    const bool opened = CardImage::compile(database, path) && image.open(path);
+    const bool same = opened && cardTableHash(image.table()) == cardTableHash(database.table());
+    std::remove(path.c_str()); // the mapping stays valid after the name is gone
+    if (!opened)
+    {
+        return "a compiled card image can not be opened";
+    }
+    if (!same)
+    {
+        return "a card image does not hold the pool it was compiled from";
+    }
+    return nullptr;
+} // checkCardImage function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkLargeCardImage()
+{
+    // thousands of cards, with decks that deal ids far above one byte into every zone of the state format
+    const int bearCount = 3000;
+    std::ostringstream text;
+    for (int i = 0; i < bearCount; i++)
+    {
+        text << "card Bear" << i << " Creature Green 0 0 1 0 0 1 2 2 - None 0 0\n";
+    }
+    text << "card Forest Land Green 0 0 0 0 0 0 0 0 - None 0 0\n"
+         << "deck 1 Forest*13 Bear" << bearCount - 2 << "*13\n"
+         << "deck 2 Forest*13 Bear" << bearCount - 1 << "*13\n";
+
+    CardDatabase database;
+    std::istringstream pool(text.str());
+    if (!database.load(pool, "large self-test pool"))
+    {
+        return "a pool of a few thousand cards is rejected";
+    }
+
+    const std::string path = std::string(P_tmpdir) + "/cards-selftest-large-" + std::to_string(getpid()) + ".img";
+    CardImage image;
+    const bool opened = CardImage::compile(database, path) && image.open(path);
+    std::remove(path.c_str());
+    if (!opened || cardTableHash(image.table()) != cardTableHash(database.table()))
+    {
+        return "a card image of a few thousand cards does not round-trip";
+    }
+    if (findCard("Forest", image.table()) != bearCount || findCard("Bear2999", image.table()) != bearCount - 1)
+    {
+        return "the name index of a large image finds the wrong ids";
+    }
+
+    GameState s;
+    std::uint64_t rng = 13;
+    if (!s.reset(13, image.table()))
+    {
+        return "the decks of a large image are not dealt";
+    }
+    while (!s.isOver())
+    {
+        std::uint8_t bytes[MaxSerializedStateBytes];
+        GameState copy;
+        const int size = serializeState(s, bytes);
+        if (deserializeState(bytes, static_cast<std::size_t>(size), copy, image.table()) != size || copy.hash() != s.hash())
+        {
+            return "a state with large card ids does not round-trip";
+        }
+        playRandomMoves(s, rng, 1, nullptr);
+    }
+    return nullptr;
+} // checkLargeCardImage function
+//----------------------------------------------------------------------------------------------------------------------
+// Every allocation through the plain operator new, counted so that --selftest can check that turns allocate nothing.
+// Over-aligned objects (the evaluator weights) use the aligned forms of the library; they are only made at setup.
+// All three stay out of line, or GCC would see malloc() and free() meet at the call sites and warn of a mismatch.
+std::atomic<std::uint64_t> heapAllocations{0};
+
+[[gnu::noinline]] void *operator new(std::size_t size)
+{
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+//----------------------------------------------------------------------------------------------------------------------
+// The zones of one side of the interactive game
+struct LegacySide
+{
+    std::vector<Card> library;
+    Hand hand;
+    std::vector<Card> inPlay;
+    std::vector<Card> discard;
+    std::unique_ptr<Mana> mana;
+    std::unique_ptr<Player> player;
+};
+
+// A turn of the interactive game with its answers given: the draw, untap, tapping the lands, playing every card the
+// mana pays for with its effect, the lethal check, the block hint and an attack with every creature, the first one
+// blocked by the first creature of the defender
+void playLegacyTurn(LegacySide &me, LegacySide &op)
+{
+    DealDamageEffect dealDamageEffect;
+    AbilityEffect abilityEffect;
+
+    baseHp(me.inPlay, me.library, me.discard, me.hand);
+    printInPlay(me.inPlay);
+    printInPlay(op.inPlay);
+    if (!me.library.empty() && !me.hand.full())
+    {
+        std::cout << "draw: " << me.library.back().getCardName() << std::endl;
+        me.hand.push_back(me.library.back());
+        me.library.pop_back();
+    }
+    untapped(me.inPlay, me.library, me.discard, me.hand);
+    for (Card &card : me.inPlay)
+    {
+        card.setTapped(me.mana);
+    }
+
+    bool landPlayed = false;
+    for (int i = 0; i < me.hand.size();)
+    {
+        Card &card = me.hand[i];
+        const bool land = card.getCardtype() == "LandCard";
+        if ((land && landPlayed) || !card.isManaE(me.mana))
+        {
+            i++;
+            continue;
+        }
+        std::cout << "played: " << card.getCardName() << std::endl;
+        landPlayed = landPlayed || land;
+        card.setTapped(me.mana);
+        card.play(me.mana);
+
+        const EffectKind effect = cardEffect(card.getCardName());
+        if (effect == EffectKind::LightningBolt)
+        {
+            dealDamageEffect.dealDamage(op.inPlay, card.getCardName(), op.player);
+        }
+        else if (effect == EffectKind::Rage)
+        {
+            abilityEffect.effectAbility(me.inPlay, card.getCardName());
+        }
+        me.inPlay.emplace_back(card);
+        me.hand.erase(i);
+    }
+    me.mana->printMana();
+    printHand(me.hand);
+
+    StaticVector<int, StandardRules.attackSquadSize> squad;
+    for (int i = 0; i < static_cast<int>(me.inPlay.size()) && !squad.full(); i++)
+    {
+        if (me.inPlay[i].isCreature())
         {
-            defenderInplay[o]->sustainDamage(attackerInplay[i]->getAttackPower());
-            std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
-
-            attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-            std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
-
-            if (defenderInplay[o]->checkDead())
-            {
-                std::cout << defenderInplay[o]->getCardName() << " is destroyed " << std::endl;
-                dc2.emplace_back(defenderInplay[o]);
-                defenderInplay.erase(defenderInplay.begin() + o);
-            }
-            if (attackerInplay[i]->checkDead())
-            {
-                std::cout << attackerInplay[i]->getCardName() << " is destroyed " << std::endl;
-                dc1.emplace_back(attackerInplay[i]);
-                attackerInplay.erase(attackerInplay.begin() + i);
-            }
+            squad.push_back(i);
         }
+    }
+    hasLethalOnBoard(me.inPlay, me.hand, me.mana, op.inPlay, op.player);
+    printBlockHint(me.inPlay, squad.data(), squad.size(), op.inPlay);
 
-        else if (attackerInplay[i]->getFirstStrike() && attackerInplay[i]->getTrample())
+    for (int a = 1; a < squad.size(); a++)
+    {
+        op.player->susDamage(me.inPlay[squad[a]].getAttackPower());
+    }
+    for (int o = 0; o < static_cast<int>(op.inPlay.size()) && !squad.empty(); o++)
+    {
+        if (op.inPlay[o].isCreature())
         {
-            defenderInplay[o]->sustainDamage(attackerInplay[i]->getAttackPower());
-            std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
-
-            if (defenderInplay[o]->checkDead())
-            {
-                std::cout << defenderInplay[o]->getCardName() << " is destroyed " << std::endl;
-                dc2.emplace_back(defenderInplay[o]);
-                defenderInplay.erase(defenderInplay.begin() + o);
-            }
-
-            if (attackerInplay[i]->getAttackPower() < defenderInplay[o]->getHp())
-            {
-                attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-                std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
-
-                if (attackerInplay[i]->getAttackPower() > defenderInplay[o]->getHp())
-                {
-                    excessAttackPower = attackerInplay[i]->getAttackPower() - defenderInplay[o]->getHp();
-                    playerOp->susDamage(excessAttackPower);
-                    std::cout << "Because of attacker card's trample ability " << excessAttackPower << " dealt to opponent player " << std::endl;
-                }
-            }
+            combat(me.inPlay, squad[0], op.inPlay, o, op.player, me.discard, op.discard);
+            break;
         }
-
-        else
+    }
+    baseHp(me.inPlay, me.library, me.discard, me.hand);
+} // playLegacyTurn function
+//----------------------------------------------------------------------------------------------------------------------
+const char *checkNoTurnAllocations()
+{
+    // headless games, after a warm-up and then played and reset in place with an observation at every decision
+    GameState s;
+    float observation[ObservationEncoder::Size];
+    std::uint8_t mask[ActionCount];
+    std::uint64_t rng = 17;
+    s.reset(17);
+    playRandomMoves(s, rng, 20, nullptr);
+
+    std::uint64_t before = heapAllocations.load();
+    for (int game = 0; game < 20; game++)
+    {
+        while (!s.isOver())
         {
-            defenderInplay[o]->sustainDamage(attackerInplay[i]->getAttackPower());
-            std::cout << attackerInplay[i]->getCardName() << " hit " << attackerInplay[i]->getAttackPower() << " damage to " << defenderInplay[o]->getCardName() << std::endl;
+            ObservationEncoder::encode(s, s.toMove(), observation, mask);
+            playRandomMoves(s, rng, 1, nullptr);
+        }
+        s.reset(18 + game);
+    }
+    if (heapAllocations.load() != before)
+    {
+        return "warmed-up headless turns allocate";
+    }
 
-            attackerInplay[i]->sustainDamage(defenderInplay[o]->getAttackPower());
-            std::cout << defenderInplay[o]->getCardName() << " hit " << defenderInplay[o]->getAttackPower() << " damage to " << attackerInplay[o]->getCardName() << std::endl;
+    // the same legacy turn twice from the same board; the first one sizes the solver tables of the hints
+    auto card = [](const char *name) { return Card::fromPrototype(BuiltinCards[findCard(name, BuiltinCardTable)]); };
+    LegacySide start[2];
+    LegacySide sides[2];
+    for (int k = 0; k < 2; k++)
+    {
+        start[k].mana = std::make_unique<Mana>();
+        start[k].player = std::make_unique<Player>();
+        start[k].library.assign(10, card("Forest"));
+        sides[k].mana = std::make_unique<Mana>();
+        sides[k].player = std::make_unique<Player>();
+        sides[k].library.reserve(PlayerState::MaxLibrary);
+        sides[k].inPlay.reserve(PlayerState::MaxLibrary);
+        sides[k].discard.reserve(PlayerState::MaxLibrary);
+    }
+    start[0].inPlay = {card("Forest"), card("Forest"), card("Forest"), card("Mountain"), card("AngryBear"), card("Hobgoblin")};
+    start[1].inPlay = {card("Plains"), card("Plains"), card("Soldier"), card("Guard")};
+    for (const char *name : {"Forest", "AngryBear", "LightningBolt", "Rage"})
+    {
+        start[0].hand.push_back(card(name));
+    }
 
-            if (defenderInplay[o]->checkDead())
-            {
-                std::cout << defenderInplay[o]->getCardName() << " is destroyed " << std::endl;
-                dc2.emplace_back(defenderInplay[o]);
-                defenderInplay.erase(defenderInplay.begin() + o);
-            }
-            if (attackerInplay[i]->checkDead())
-            {
-                std::cout << attackerInplay[i]->getCardName() << " is destroyed " << std::endl;
-                dc1.emplace_back(attackerInplay[i]);
-                attackerInplay.erase(attackerInplay.begin() + i);
-            }
+    std::stringbuf answers("1\n1\n"); // each LightningBolt hits the player
+    std::streambuf *input = std::cin.rdbuf(&answers);
+    std::streambuf *output = std::cout.rdbuf(nullptr); // the turn prints into a stream that drops everything
+    std::uint64_t turnAllocations = 0;
+    for (int turn = 0; turn < 2; turn++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            sides[k].library = start[k].library;
+            sides[k].hand = start[k].hand;
+            sides[k].inPlay = start[k].inPlay;
+            sides[k].discard = start[k].discard;
+            *sides[k].mana = *start[k].mana;
+            *sides[k].player = *start[k].player;
         }
+        before = heapAllocations.load();
+        playLegacyTurn(sides[0], sides[1]);
+        turnAllocations = heapAllocations.load() - before;
     }
-    else
+    std::cin.rdbuf(input);
+    std::cout.rdbuf(output);
+
+    if (sides[1].player->getHp() == start[1].player->getHp())
     {
-        std::cout << "Player take " << attackerInplay[i]->getAttackPower() << " damage" << std::endl;
-        playerOp->susDamage(attackerInplay[i]->getAttackPower());
+        return "the legacy turn does not reach the defender";
     }
-} // combat function
+    if (turnAllocations != 0)
+    {
+        return "a warmed-up legacy turn allocates";
+    }
+    return nullptr;
+} // checkNoTurnAllocations function
 //----------------------------------------------------------------------------------------------------------------------
-// For print the cards in inPlay
-void printInPlay(std::vector<std::shared_ptr<Card>> &ip)
+/**
+ * @brief Runs the behavior checks of the headless engine on the built-in cards: --selftest.
+ *
+ * @return The process exit code: 0 if every check passes, 1 otherwise.
+ */
+int selfTestCommand()
 {
-    auto it = ip.begin();
-    int counter = 0;
-    std::cout << " cards that in play: " << std::endl;
-    for (it = ip.begin(); it != ip.end(); it++)
+    static const struct
     {
-        std::cout << counter << ")" << (*it)->getCardName() << "  ";
-        counter++;
+        const char *name;
+        const char *(*check)();
+    } Checks[] = {{"endgame solver finds a mate", checkEndgameMate},
+                  {"AiPlayer only answers with legal moves", checkAiPlayerMoves},
+                  {"BatchEnv steps alike on one and four threads", checkBatchEnvDeterminism},
+                  {"state serialization round trip", checkStateRoundTrip},
+                  {"replay, seekTurn and parallel verify match the live game", checkReplay},
+                  {"card database load", checkCardDatabase},
+                  {"card image compile and open", checkCardImage},
+                  {"card image of a few thousand cards", checkLargeCardImage},
+                  {"warmed-up turns do not allocate", checkNoTurnAllocations}};
+
+    int failed = 0;
+    for (const auto &c : Checks)
+    {
+        const char *error = c.check();
+        std::cout << (error == nullptr ? "ok      " : "FAILED  ") << c.name << (error == nullptr ? "" : ": ") << (error == nullptr ? "" : error)
+                  << std::endl;
+        failed += error != nullptr;
     }
-} // printInPlay function
+    std::cout << (sizeof(Checks) / sizeof(Checks[0]) - failed) << " of " << sizeof(Checks) / sizeof(Checks[0]) << " checks passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+} // selfTestCommand function
 //----------------------------------------------------------------------------------------------------------------------
-// For print the cards in hand
-void printHand(std::vector<std::shared_ptr<Card>> &hand)
+/**
+ * @brief Re-checks a saved replay log with the card pool it was recorded with: --replay <log>.
+ *
+ * @return The process exit code.
+ */
+int replayCommand(int argc, char **argv)
 {
-    auto it = hand.begin();
-    int counter = 0;
-    std::cout << " cards that in hand: " << std::endl;
-    for (it = hand.begin(); it != hand.end(); it++)
+    if (argc != 3)
     {
-        std::cout << counter << ")" << (*it)->getCardName() << "  ";
-        counter++;
+        std::cout << "usage: " << argv[0] << " --replay <log>" << std::endl;
+        return 2;
     }
-} // printHand function
-//======================================================================================================================
-int main()
+
+    ReplayLog log;
+    if (!log.loadFile(argv[2]))
+    {
+        std::cout << "replay log " << argv[2] << " could not be read" << std::endl;
+        return 1;
+    }
+
+    // games of the interactive pool replay with it, self-play games with the built-in one
+    CardDatabase database;
+    std::ifstream cards("cards.txt");
+    if (cards && database.load(cards, "cards.txt") && cardTableHash(database.table()) == log.getTableHash())
+    {
+        useCardTable(database.table());
+    }
+
+    const ReplayResult r = replayGame(log);
+    const int segment = verifyReplayParallel(log);
+    std::cout << r.applied << " of " << log.getDecisionCount() << " decisions replayed, turn " << r.state.turn << ", winner " << r.state.winner << std::endl;
+    if (!r.ok || segment != -1)
+    {
+        std::cout << "replay does not match: " << (r.error != nullptr ? r.error : "segment check failed") << std::endl;
+        return 1;
+    }
+    std::cout << "replay matches the recording" << std::endl;
+    return 0;
+} // replayCommand function
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @class InputRecorder
+ * @brief A stream buffer that reads through another one and copies every character it hands out to a record file.
+ *
+ * Installed as the buffer of std::cin it records everything the interactive game reads, a line at a time, so the
+ * record of a session that crashed is complete up to the line that crashed it.
+ */
+class InputRecorder : public std::streambuf
+{
+public:
+    InputRecorder(std::streambuf *source, std::ostream &record) : source(source), record(record) {}
+
+protected:
+    int_type underflow() override
+    {
+        const int_type c = source->sbumpc();
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            return traits_type::eof();
+        }
+
+        current = traits_type::to_char_type(c);
+        record.put(current);
+        if (current == '\n')
+        {
+            record.flush();
+        }
+        setg(&current, &current, &current + 1);
+        return c;
+    }
+
+private:
+    std::streambuf *source;
+    std::ostream &record;
+    char current = 0;
+}; // InputRecorder class
+//----------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief The interactive two player game, dealt from the decks 1 and 2 of a card pool.
+ *
+ * The pool has to be the active one (see useCardTable()), since Mana looks the cards up by name in it. The deals
+ * come from rand(), so the seed and the input lines are all a session needs to play again.
+ */
+int playLegacyGame(const CardTable &table, unsigned seed)
 {
-    srand(time(NULL));
+    srand(seed);
+    std::cout << "game seed " << seed << std::endl;
     system("Color C");
     system("TREE");
 
     /// to form libraries
 
-    std::vector<std::shared_ptr<Card>> library1;
-    std::vector<std::shared_ptr<Card>> library2;
+    std::vector<Card> library1;
+    std::vector<Card> library2;
 
     /// to form hands
 
-    std::vector<std::shared_ptr<Card>> hand1;
-    std::vector<std::shared_ptr<Card>> hand2;
+    Hand hand1;
+    Hand hand2;
 
     /// to form inPlay
 
-    std::vector<std::shared_ptr<Card>> inPlay1;
-    std::vector<std::shared_ptr<Card>> inPlay2;
+    std::vector<Card> inPlay1;
+    std::vector<Card> inPlay2;
 
     /// to form discards
 
-    std::vector<std::shared_ptr<Card>> discard1;
-    std::vector<std::shared_ptr<Card>> discard2;
+    std::vector<Card> discard1;
+    std::vector<Card> discard2;
 
     /// to form manas
     std::unique_ptr<Mana> mana1 = std::make_unique<Mana>();
@@ -1504,209 +9336,22 @@ int main()
     ReviveFromGraveEffect reviveFromGraveEffectObj;
     AbilityEffect abilityEffectObj;
 
-    /// Cards-----------------------------------------------------------------------------------------------------------------
-
-    /// land cards
-
-    std::shared_ptr<LandCard> forest1 = std::make_shared<LandCard>("Forest", "LandCard", 0);
-    std::shared_ptr<LandCard> forest2 = std::make_shared<LandCard>("Forest", "LandCard", 0);
-    std::shared_ptr<LandCard> forest3 = std::make_shared<LandCard>("Forest", "LandCard", 0);
-
-    std::shared_ptr<LandCard> island = std::make_shared<LandCard>("Island", "LandCard", 0);
-
-    std::shared_ptr<LandCard> mountain1 = std::make_shared<LandCard>("Mountain", "LandCard", 0);
-    std::shared_ptr<LandCard> mountain2 = std::make_shared<LandCard>("Mountain", "LandCard", 0);
-    std::shared_ptr<LandCard> mountain3 = std::make_shared<LandCard>("Mountain", "LandCard", 0);
-
-    std::shared_ptr<LandCard> plains1 = std::make_shared<LandCard>("Plains", "LandCard", 0);
-    std::shared_ptr<LandCard> plains2 = std::make_shared<LandCard>("Plains", "LandCard", 0);
-    std::shared_ptr<LandCard> plains3 = std::make_shared<LandCard>("Plains", "LandCard", 0);
-    std::shared_ptr<LandCard> plains4 = std::make_shared<LandCard>("Plains", "LandCard", 0);
-    std::shared_ptr<LandCard> plains5 = std::make_shared<LandCard>("Plains", "LandCard", 0);
-
-    std::shared_ptr<LandCard> swamp1 = std::make_shared<LandCard>("Swamp", "LandCard", 0);
-    std::shared_ptr<LandCard> swamp2 = std::make_shared<LandCard>("Swamp", "LandCard", 0);
-    std::shared_ptr<LandCard> swamp3 = std::make_shared<LandCard>("Swamp", "LandCard", 0);
-    std::shared_ptr<LandCard> swamp4 = std::make_shared<LandCard>("Swamp", "LandCard", 0);
-    std::shared_ptr<LandCard> swamp5 = std::make_shared<LandCard>("Swamp", "LandCard", 0);
-
-    /// creature cards
-
-    std::shared_ptr<CreatureCard> soldier1 = std::make_shared<CreatureCard>("Soldier", "CreatureCard", "White", 1, 1,
-                                                                            "W", false, false);
-    std::shared_ptr<CreatureCard> soldier2 = std::make_shared<CreatureCard>("Soldier", "CreatureCard", "White", 1, 1,
-                                                                            "W", false, false);
-    std::shared_ptr<CreatureCard> soldier3 = std::make_shared<CreatureCard>("Soldier", "CreatureCard", "White", 1, 1,
-                                                                            "W", false, false);
-
-    std::shared_ptr<CreatureCard> armoredPegasus1 = std::make_shared<CreatureCard>("ArmoredPegasus", "CreatureCard",
-                                                                                   "White", 1, 2, "1W", false, false);
-    std::shared_ptr<CreatureCard> armoredPegasus2 = std::make_shared<CreatureCard>("ArmoredPegasus", "CreatureCard",
-                                                                                   "White", 1, 2, "1W", false, false);
-
-    std::shared_ptr<CreatureCard> whiteKnight1 = std::make_shared<CreatureCard>("WhiteKnight", "CreatureCard", "White",
-                                                                                2, 2, "WW", true, false);
-    std::shared_ptr<CreatureCard> whiteKnight2 = std::make_shared<CreatureCard>("WhiteKnight", "CreatureCard", "White",
-                                                                                2, 2, "WW", true, false);
-
-    std::shared_ptr<CreatureCard> angryBear = std::make_shared<CreatureCard>("AngryBear", "CreatureCard", "Green", 3, 2,
-                                                                             "2G", false, true);
-
-    std::shared_ptr<CreatureCard> guard = std::make_shared<CreatureCard>("Guard", "CreatureCard", "White", 2, 5, "2WW",
-                                                                         false, false);
-
-    std::shared_ptr<CreatureCard> werewolf = std::make_shared<CreatureCard>("Werewolf", "CreatureCard", "Green", 4, 6,
-                                                                            "2GW", false, true);
-
-    std::shared_ptr<CreatureCard> skeleton1 = std::make_shared<CreatureCard>("Skeleton", "CreatureCard", "Black", 1, 1,
-                                                                             "B", false, false);
-    std::shared_ptr<CreatureCard> skeleton2 = std::make_shared<CreatureCard>("Skeleton", "CreatureCard", "Black", 1, 1,
-                                                                             "B", false, false);
-    std::shared_ptr<CreatureCard> skeleton3 = std::make_shared<CreatureCard>("Skeleton", "CreatureCard", "Black", 1, 1,
-                                                                             "B", false, false);
-
-    std::shared_ptr<CreatureCard> ghost1 = std::make_shared<CreatureCard>("Ghost", "CreatureCard", "Black", 2, 1, "1B",
-                                                                          false, false);
-    std::shared_ptr<CreatureCard> ghost2 = std::make_shared<CreatureCard>("Ghost", "CreatureCard", "Black", 2, 1, "1B",
-                                                                          false, false);
-
-    std::shared_ptr<CreatureCard> blackKnight1 = std::make_shared<CreatureCard>("BlackKnight", "CreatureCard", "Black",
-                                                                                2, 2, "BB", true, false);
-    std::shared_ptr<CreatureCard> blackKnight2 = std::make_shared<CreatureCard>("BlackKnight", "CreatureCard", "Black",
-                                                                                2, 2, "BB", true, false);
-
-    std::shared_ptr<CreatureCard> orcManiac = std::make_shared<CreatureCard>("OrcManiac", "CreatureCard", "Red", 4, 1,
-                                                                             "2R", false, false);
+    /// libraries, from the deck lists of the card pool
 
-    std::shared_ptr<CreatureCard> hobgoblin = std::make_shared<CreatureCard>("Hobgoblin", "CreatureCard", "Red", 3, 3,
-                                                                             "1RB", false, false);
-
-    std::shared_ptr<CreatureCard> vampire = std::make_shared<CreatureCard>("Vampire", "CreatureCard", "Black", 6, 3,
-                                                                           "3B", false, false);
-
-    // sorcery cards
-
-    std::shared_ptr<SorceryCard> disenchant = std::make_shared<SorceryCard>("Disenchant", "White", "1W",
-                                                                            "Destroy 1 Target Enchantment");
-
-    std::shared_ptr<SorceryCard> lightningBolt = std::make_shared<SorceryCard>("LightningBolt", "Green", "1G",
-                                                                               "Deal 2 dmg to target creature or player");
-
-    std::shared_ptr<SorceryCard> flood1 = std::make_shared<SorceryCard>("Flood", "Green", "1GW",
-                                                                        "Destroy 1 Target Land");
-    std::shared_ptr<SorceryCard> flood2 = std::make_shared<SorceryCard>("Flood", "Green", "1GW",
-                                                                        "Destroy 1 Target Land");
-
-    std::shared_ptr<SorceryCard> reanimate = std::make_shared<SorceryCard>("Reanimate", "Black", "B",
-                                                                           "Return 1 character card from discard to hand");
-
-    std::shared_ptr<SorceryCard> plague = std::make_shared<SorceryCard>("Plague", "Black", "2B",
-                                                                        "Deal 1 dmg to all creatures");
-
-    std::shared_ptr<SorceryCard> terror1 = std::make_shared<SorceryCard>("Terror", "Black", "1B",
-                                                                         "Destroy 1 Target Creature");
-    std::shared_ptr<SorceryCard> terror2 = std::make_shared<SorceryCard>("Terror", "Black", "1B",
-                                                                         "Destroy 1 Target Creature");
-
-    // enchantment cards
-
-    std::shared_ptr<EnhancementCard> rage = std::make_shared<EnhancementCard>("Rage", "Green", "G",
-                                                                              "1 Target creature gains Trample");
-
-    std::shared_ptr<EnhancementCard> holyWar = std::make_shared<EnhancementCard>("HolyWar", "White", "1W",
-                                                                                 "All white creatures gain +1/+1");
-
-    std::shared_ptr<EnhancementCard> holyLight = std::make_shared<EnhancementCard>("HolyLight", "White", "1W",
-                                                                                   "All black creatures gain -1/-1");
-
-    std::shared_ptr<EnhancementCard> unholyWar = std::make_shared<EnhancementCard>("UnholyWar", "Black", "1B",
-                                                                                   "All black creatures gain +2/+0");
-
-    std::shared_ptr<EnhancementCard> restrain = std::make_shared<EnhancementCard>("Restrain", "Red", "2R",
-                                                                                  "All green creatures lose Trample");
-
-    std::shared_ptr<EnhancementCard> slow = std::make_shared<EnhancementCard>("Slow", "Black", "B",
-                                                                              "1 Target creature loses First Strike");
-
-    //----------------------------------------------------------------------------------------------------------------------
-
-    /// lib1
-
-    library1.emplace_back(plains1);
-    library1.emplace_back(plains2);
-    library1.emplace_back(plains3);
-    library1.emplace_back(plains4);
-    library1.emplace_back(plains5);
-
-    library1.emplace_back(forest1);
-    library1.emplace_back(forest2);
-    library1.emplace_back(forest3);
-
-    library1.emplace_back(island);
-
-    library1.emplace_back(soldier1);
-    library1.emplace_back(soldier2);
-    library1.emplace_back(soldier3);
-
-    library1.emplace_back(armoredPegasus1);
-    library1.emplace_back(armoredPegasus2);
-
-    library1.emplace_back(whiteKnight1);
-    library1.emplace_back(whiteKnight2);
-
-    library1.emplace_back(angryBear);
-
-    library1.emplace_back(guard);
-
-    library1.emplace_back(werewolf);
-
-    library1.emplace_back(disenchant);
-    library1.emplace_back(lightningBolt);
-    library1.emplace_back(flood1);
-    library1.emplace_back(flood2);
-
-    library1.emplace_back(rage);
-    library1.emplace_back(holyWar);
-    library1.emplace_back(holyLight);
-
-    /// lib2
-
-    library2.emplace_back(swamp1);
-    library2.emplace_back(swamp2);
-    library2.emplace_back(swamp3);
-    library2.emplace_back(swamp4);
-    library2.emplace_back(swamp5);
-
-    library2.emplace_back(mountain1);
-    library2.emplace_back(mountain2);
-    library2.emplace_back(mountain3);
-
-    library2.emplace_back(island);
-
-    library2.emplace_back(skeleton1);
-    library2.emplace_back(skeleton2);
-    library2.emplace_back(skeleton3);
-
-    library2.emplace_back(ghost1);
-    library2.emplace_back(ghost2);
-
-    library2.emplace_back(blackKnight1);
-    library2.emplace_back(blackKnight2);
-
-    library2.emplace_back(orcManiac);
-
-    library2.emplace_back(hobgoblin);
-
-    library2.emplace_back(vampire);
-
-    library2.emplace_back(reanimate);
-    library2.emplace_back(plague);
-    library2.emplace_back(terror1);
-    library2.emplace_back(terror2);
+    for (int i = 0; i < table.deckSizes[0]; i++)
+    {
+        library1.push_back(Card::fromPrototype(table.cards[table.decks[0][i]]));
+    }
+    for (int i = 0; i < table.deckSizes[1]; i++)
+    {
+        library2.push_back(Card::fromPrototype(table.cards[table.decks[1][i]]));
+    }
 
-    library2.emplace_back(unholyWar);
-    library2.emplace_back(restrain);
-    library2.emplace_back(slow);
+    /// every card of a side fits in each of its zones, so moving cards between them never reallocates
+    inPlay1.reserve(library1.size());
+    discard1.reserve(library1.size());
+    inPlay2.reserve(library2.size());
+    discard2.reserve(library2.size());
 
     //----------------------------------------------------------------------------------------------------------------------
 
@@ -1749,16 +9394,16 @@ int main()
             std::cout << "----------------------------------DRAW PHASE----------------------------------" << std::endl
                       << std::endl;
 
-            if (library1.size() != 0 && hand1.size() < 7)
+            if (library1.size() != 0 && hand1.size() < StandardRules.handLimit)
             {
-                std::cout << "Player1 draw: " << library1[library1.size() - 1]->getCardName() << std::endl;
-                hand1.emplace_back(library1[library1.size() - 1]);
+                std::cout << "Player1 draw: " << library1[library1.size() - 1].getCardName() << std::endl;
+                hand1.push_back(library1[library1.size() - 1]);
                 library1.pop_back();
             }
-            else if (hand1.size() >= 7 && library1.size() != 0)
+            else if (hand1.size() >= StandardRules.handLimit && library1.size() != 0)
             {
                 std::cout
-                    << "you have 7 cards in your hand its the limit you can not draw 1 more. Drawn card send to discard pile."
+                    << "you have " << StandardRules.handLimit << " cards in your hand its the limit you can not draw 1 more. Drawn card send to discard pile."
                     << std::endl
                     << std::endl;
                 discard1.emplace_back(library1[library1.size() - 1]);
@@ -1800,9 +9445,9 @@ int main()
 
             for (int i = 0; i < inPlay1.size(); i++)
             {
-                if (inPlay1[i]->getCardtype() == "LandCard")
+                if (inPlay1[i].getCardtype() == "LandCard")
                 {
-                    inPlay1[i]->setTapped(mana1);
+                    inPlay1[i].setTapped(mana1);
                 }
             }
             std::cout
@@ -1827,7 +9472,7 @@ int main()
                 for (it444 = hand1.begin(); it444 != hand1.end(); it444++)
                 {
                     std::cout << i << ")";
-                    (*it444)->printCardName();
+                    it444->printCardName();
                     std::cout << "  ";
                     i++;
                 }
@@ -1849,100 +9494,106 @@ int main()
                     break;
                 }
 
-                else if (hand1[i]->isManaE(mana1))
+                else if (i < 0 || i >= hand1.size())
+                {
+                    std::cout << "There is no card with that index in your hand" << std::endl;
+                }
+                else if (hand1[i].isManaE(mana1))
                 {
 
                     std::vector<Card>::iterator itXXX;
 
-                    if (hand1[i]->getCardtype() == "LandCard")
+                    if (hand1[i].getCardtype() == "LandCard")
                     {
                         if (a < 1)
                         {
                             a++;
-                            std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                            hand1[i]->setTapped(mana1);
-                            hand1[i]->play(mana1);
+                            std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                            hand1[i].setTapped(mana1);
+                            hand1[i].play(mana1);
                             //(itXXX+i)->play(mana1);
                             inPlay1.emplace_back(hand1[i]);
-                            hand1.erase(hand1.begin() + i);
+                            hand1.erase(i);
                         }
                         else
                         {
                             std::cout << "you already have played land card you can not play 1 more" << std::endl;
                         }
                     }
-                    else if (hand1[i]->getCardtype() == "SorceryCard")
+                    else if (hand1[i].getCardtype() == "SorceryCard")
                     {
-                        std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                        hand1[i]->play(mana1);
+                        std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                        hand1[i].play(mana1);
 
-                        if (hand1[i]->getCardName() == "Disenchant")
+                        const EffectKind effect = cardEffect(hand1[i].getCardName());
+                        if (effect == EffectKind::Disenchant)
                         {
-                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i]->getCardName());
+                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "LightningBolt")
+                        else if (effect == EffectKind::LightningBolt)
                         {
-                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i]->getCardName(), player2);
+                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i].getCardName(), player2);
                         }
-                        else if (hand1[i]->getCardName() == "Flood")
+                        else if (effect == EffectKind::Flood)
                         {
-                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i]->getCardName());
+                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "Reanimate")
+                        else if (effect == EffectKind::Reanimate)
                         {
                             reviveFromGraveEffectObj.revive(discard1, hand1);
                         }
-                        else if (hand1[i]->getCardName() == "Plague")
+                        else if (effect == EffectKind::Plague)
                         {
-                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i]->getCardName(), player2);
+                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i].getCardName(), player2);
                         }
-                        else if (hand1[i]->getCardName() == "Terror")
+                        else if (effect == EffectKind::Terror)
                         {
-                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i]->getCardName());
+                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i].getCardName());
                         }
 
                         inPlay1.emplace_back(hand1[i]);
-                        hand1.erase(hand1.begin() + i);
+                        hand1.erase(i);
                     }
-                    else if (hand1[i]->getCardtype() == "EnhancementCard")
+                    else if (hand1[i].getCardtype() == "EnhancementCard")
                     {
-                        std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                        hand1[i]->play(mana1);
+                        std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                        hand1[i].play(mana1);
 
-                        if (hand1[i]->getCardName() == "Rage")
+                        const EffectKind effect = cardEffect(hand1[i].getCardName());
+                        if (effect == EffectKind::Rage)
                         {
-                            abilityEffectObj.effectAbility(inPlay1, hand1[i]->getCardName());
+                            abilityEffectObj.effectAbility(inPlay1, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "HolyWar")
+                        else if (effect == EffectKind::HolyWar)
                         {
-                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i]->getCardName());
+                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "HolyLight")
+                        else if (effect == EffectKind::HolyLight)
                         {
-                            effectForColorEffectObj.effectThatColorMembers(inPlay2, hand1[i]->getCardName());
+                            effectForColorEffectObj.effectThatColorMembers(inPlay2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "UnholyWar")
+                        else if (effect == EffectKind::UnholyWar)
                         {
-                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i]->getCardName());
+                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "Restrain")
+                        else if (effect == EffectKind::Restrain)
                         {
-                            abilityEffectObj.effectAbility(inPlay2, hand1[i]->getCardName());
+                            abilityEffectObj.effectAbility(inPlay2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "Slow")
+                        else if (effect == EffectKind::Slow)
                         {
-                            abilityEffectObj.effectAbility(inPlay2, hand1[i]->getCardName());
+                            abilityEffectObj.effectAbility(inPlay2, hand1[i].getCardName());
                         }
 
                         inPlay1.emplace_back(hand1[i]);
-                        hand1.erase(hand1.begin() + i);
+                        hand1.erase(i);
                     }
                     else
                     {
-                        std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                        hand1[i]->play(mana1);
+                        std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                        hand1[i].play(mana1);
                         inPlay1.emplace_back(hand1[i]);
-                        hand1.erase(hand1.begin() + i);
+                        hand1.erase(i);
                     }
                     if (player1->getHp() <= 0 || player2->getHp() <= 0)
                     {
@@ -1977,12 +9628,12 @@ int main()
                 << std::endl
                 << std::endl;
 
-            int ops;
+            int ops = 0;
 
             int counter = 0;
             for (int i = 0; i < inPlay1.size(); i++)
             {
-                if (inPlay1[i]->getCardtype() == "CreatureCard")
+                if (inPlay1[i].getCardtype() == "CreatureCard")
                 {
                     counter++;
                 }
@@ -1991,6 +9642,12 @@ int main()
             if (counter > 0)
             {
 
+                if (hasLethalOnBoard(inPlay1, hand1, mana1, inPlay2, player2))
+                {
+                    std::cout << "Player1 can deal lethal damage this turn by attacking with every untapped creature and casting every LightningBolt the mana pays for at Player2" << std::endl
+                              << std::endl;
+                }
+
                 std::cout
                     << "please choose your attack squad one by one via typing its index number.Untapped creature cards will be listed below"
                     << std::endl
@@ -1998,22 +9655,21 @@ int main()
 
                 for (int i = 0; i < inPlay1.size(); i++)
                 {
-                    if (!inPlay1[i]->hasTappedInfo() && inPlay1[i]->getCardtype() == "CreatureCard")
+                    if (!inPlay1[i].hasTappedInfo() && inPlay1[i].getCardtype() == "CreatureCard")
                     {
-                        std::cout << i << ")" << inPlay1[i]->getCardName() << "  ";
+                        std::cout << i << ")" << inPlay1[i].getCardName() << "  ";
                     }
                 }
 
                 bool done = false;
-                int indexNumber;
-                int squadIndexLog[9];
-                int mmm = 0;
+                int indexNumber = 0;
+                StaticVector<int, StandardRules.attackSquadSize> squadIndexLog;
 
                 std::cout << std::endl;
                 std::cout
                     << "if you just want to pass and if you dont want to attack please type 9; if you type any number expect 9 you have to attack"
                     << std::endl;
-                int ops2;
+                int ops2 = 0;
                 while (!done)
                 {
 
@@ -2031,21 +9687,28 @@ int main()
                             << std::endl;
                         for (int i = 0; i < inPlay1.size(); i++)
                         {
-                            if (!inPlay1[i]->hasTappedInfo() && inPlay1[i]->getCardtype() == "CreatureCard")
+                            if (!inPlay1[i].hasTappedInfo() && inPlay1[i].getCardtype() == "CreatureCard")
                             {
-                                std::cout << i << ")" << inPlay1[i]->getCardName() << "  " << std::endl;
+                                std::cout << i << ")" << inPlay1[i].getCardName() << "  " << std::endl;
                             }
                         }
                         std::cin >> indexNumber;
-                        squadIndexLog[mmm] = indexNumber;
-                        mmm++;
-                        inPlay1[indexNumber]->setTapped(mana1);
+                        if (indexNumber < 0 || indexNumber >= static_cast<int>(inPlay1.size()) || inPlay1[indexNumber].hasTappedInfo() ||
+                            inPlay1[indexNumber].getCardtype() != "CreatureCard")
+                        {
+                            std::cout << "There is no untapped creature card with that index" << std::endl;
+                        }
+                        else
+                        {
+                            squadIndexLog.push_back(indexNumber);
+                            inPlay1[indexNumber].setTapped(mana1);
+                        }
 
                         std::cout
                             << "if you are done with forming your attack squad please type 9 if you want to choose more for your attack squad please type 0"
                             << std::endl;
                         std::cin >> ops;
-                        if (ops == 9)
+                        if (ops == 9 || squadIndexLog.full())
                         {
                             done = true;
                         }
@@ -2062,36 +9725,39 @@ int main()
                     std::cout
                         << "dear opponent player, I mean player2, your opponent has formed its attack squad you are in danger!!! now you can choose your defence squad to arrange a welcome "
                         << std::endl;
-                    std::cout << "they are " << mmm
+                    std::cout << "they are " << squadIndexLog.size()
                               << " many so you must choose that many defence card for your sake otherwise the excessive damage will effect your main HP if they can dominate your defence"
                               << std::endl;
                     std::cout << "below is the list of attackers " << std::endl;
 
-                    for (int i = 0; i < mmm; i++)
+                    for (int i = 0; i < squadIndexLog.size(); i++)
                     {
-                        std::cout << inPlay1[squadIndexLog[i]]->getCardName() << std::endl;
+                        std::cout << inPlay1[squadIndexLog[i]].getCardName() << std::endl;
                     }
 
                     std::cout << "below is the list of creature cards that you can choose for your defence squad "
                               << std::endl;
                     for (int i = 0; i < inPlay2.size(); i++)
                     {
-                        if (!inPlay2[i]->hasTappedInfo() && inPlay2[i]->getCardtype() == "CreatureCard")
+                        if (!inPlay2[i].hasTappedInfo() && inPlay2[i].getCardtype() == "CreatureCard")
                         {
-                            std::cout << i << ")" << inPlay2[i]->getCardName();
+                            std::cout << i << ")" << inPlay2[i].getCardName();
                         }
                     }
 
-                    for (int i = 0; i < mmm; i++)
+                    std::cout << std::endl;
+                    printBlockHint(inPlay1, squadIndexLog.data(), squadIndexLog.size(), inPlay2);
+
+                    for (int i = 0; i < squadIndexLog.size(); i++)
                     {
-                        std::cout << i << ". attacker is " << inPlay1[squadIndexLog[i]]->getCardName()
+                        std::cout << i << ". attacker is " << inPlay1[squadIndexLog[i]].getCardName()
                                   << ". Choose your defender via typing its index number. To pass this attacker type 9"
                                   << std::endl;
                         std::cin >> ops;
                         if (ops == 9)
                         {
-                            player2->susDamage(inPlay1[squadIndexLog[i]]->getAttackPower());
-                            std::cout << "Player take " << inPlay1[squadIndexLog[i]]->getAttackPower() << " damage" << std::endl;
+                            player2->susDamage(inPlay1[squadIndexLog[i]].getAttackPower());
+                            std::cout << "Player take " << inPlay1[squadIndexLog[i]].getAttackPower() << " damage" << std::endl;
                         }
                         // else{combat(inPlay1[squadIndexLog[i]],inPlay2[ops],player2);}
                         else
@@ -2141,7 +9807,7 @@ int main()
                 for (it444 = hand1.begin(); it444 != hand1.end(); it444++)
                 {
                     std::cout << i << ")";
-                    (*it444)->printCardName();
+                    it444->printCardName();
                     std::cout << "  ";
                     i++;
                 }
@@ -2157,100 +9823,106 @@ int main()
                 {
                     break;
                 }
-                else if (hand1[i]->isManaE(mana1))
+                else if (i < 0 || i >= hand1.size())
+                {
+                    std::cout << "There is no card with that index in your hand" << std::endl;
+                }
+                else if (hand1[i].isManaE(mana1))
                 {
 
                     std::vector<Card>::iterator itXXX;
 
-                    if (hand1[i]->getCardtype() == "LandCard")
+                    if (hand1[i].getCardtype() == "LandCard")
                     {
                         if (a < 1)
                         {
                             a++;
-                            std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                            hand1[i]->setTapped(mana1);
-                            hand1[i]->play(mana1);
+                            std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                            hand1[i].setTapped(mana1);
+                            hand1[i].play(mana1);
                             //(itXXX+i)->play(mana1);
                             inPlay1.emplace_back(hand1[i]);
-                            hand1.erase(hand1.begin() + i);
+                            hand1.erase(i);
                         }
                         else
                         {
                             std::cout << "you already have played land in 1. play phase of this round card you can not play 1 more" << std::endl;
                         }
                     }
-                    else if (hand1[i]->getCardtype() == "SorceryCard")
+                    else if (hand1[i].getCardtype() == "SorceryCard")
                     {
-                        std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                        hand1[i]->play(mana1);
+                        std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                        hand1[i].play(mana1);
 
-                        if (hand1[i]->getCardName() == "Disenchant")
+                        const EffectKind effect = cardEffect(hand1[i].getCardName());
+                        if (effect == EffectKind::Disenchant)
                         {
-                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i]->getCardName());
+                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "LightningBolt")
+                        else if (effect == EffectKind::LightningBolt)
                         {
-                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i]->getCardName(), player2);
+                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i].getCardName(), player2);
                         }
-                        else if (hand1[i]->getCardName() == "Flood")
+                        else if (effect == EffectKind::Flood)
                         {
-                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i]->getCardName());
+                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "Reanimate")
+                        else if (effect == EffectKind::Reanimate)
                         {
                             reviveFromGraveEffectObj.revive(discard1, hand1);
                         }
-                        else if (hand1[i]->getCardName() == "Plague")
+                        else if (effect == EffectKind::Plague)
                         {
-                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i]->getCardName(), player2);
+                            dealDamageEffectObj.dealDamage(inPlay2, hand1[i].getCardName(), player2);
                         }
-                        else if (hand1[i]->getCardName() == "Terror")
+                        else if (effect == EffectKind::Terror)
                         {
-                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i]->getCardName());
+                            destroyCardEffectObj.destroyCardEffectFunc(inPlay2, discard2, hand1[i].getCardName());
                         }
 
                         inPlay1.emplace_back(hand1[i]);
-                        hand1.erase(hand1.begin() + i);
+                        hand1.erase(i);
                     }
-                    else if (hand1[i]->getCardtype() == "EnhancementCard")
+                    else if (hand1[i].getCardtype() == "EnhancementCard")
                     {
-                        std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                        hand1[i]->play(mana1);
+                        std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                        hand1[i].play(mana1);
 
-                        if (hand1[i]->getCardName() == "Rage")
+                        const EffectKind effect = cardEffect(hand1[i].getCardName());
+                        if (effect == EffectKind::Rage)
                         {
-                            abilityEffectObj.effectAbility(inPlay1, hand1[i]->getCardName());
+                            abilityEffectObj.effectAbility(inPlay1, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "HolyWar")
+                        else if (effect == EffectKind::HolyWar)
                         {
-                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i]->getCardName());
+                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "HolyLight")
+                        else if (effect == EffectKind::HolyLight)
                         {
-                            effectForColorEffectObj.effectThatColorMembers(inPlay2, hand1[i]->getCardName());
+                            effectForColorEffectObj.effectThatColorMembers(inPlay2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "UnholyWar")
+                        else if (effect == EffectKind::UnholyWar)
                         {
-                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i]->getCardName());
+                            effectForColorEffectObj.effectThatColorMembers(inPlay1, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "Restrain")
+                        else if (effect == EffectKind::Restrain)
                         {
-                            abilityEffectObj.effectAbility(inPlay2, hand1[i]->getCardName());
+                            abilityEffectObj.effectAbility(inPlay2, hand1[i].getCardName());
                         }
-                        else if (hand1[i]->getCardName() == "Slow")
+                        else if (effect == EffectKind::Slow)
                         {
-                            abilityEffectObj.effectAbility(inPlay2, hand1[i]->getCardName());
+                            abilityEffectObj.effectAbility(inPlay2, hand1[i].getCardName());
                         }
 
                         inPlay1.emplace_back(hand1[i]);
-                        hand1.erase(hand1.begin() + i);
+                        hand1.erase(i);
                     }
                     else
                     {
-                        std::cout << "Player1 played: " << hand1[i]->getCardName() << std::endl;
-                        hand1[i]->play(mana1);
+                        std::cout << "Player1 played: " << hand1[i].getCardName() << std::endl;
+                        hand1[i].play(mana1);
                         inPlay1.emplace_back(hand1[i]);
-                        hand1.erase(hand1.begin() + i);
+                        hand1.erase(i);
                     }
                 }
                 else
@@ -2308,16 +9980,16 @@ int main()
                     break;
                 }
 
-                if (library2.size() != 0 && hand2.size() < 7)
+                if (library2.size() != 0 && hand2.size() < StandardRules.handLimit)
                 {
-                    std::cout << "Player2 draw: " << library2[library2.size() - 1]->getCardName() << std::endl;
-                    hand2.emplace_back(library2[library2.size() - 1]);
+                    std::cout << "Player2 draw: " << library2[library2.size() - 1].getCardName() << std::endl;
+                    hand2.push_back(library2[library2.size() - 1]);
                     library2.pop_back();
                 }
-                else if (hand2.size() >= 7 && library2.size() != 0)
+                else if (hand2.size() >= StandardRules.handLimit && library2.size() != 0)
                 {
                     std::cout
-                        << "you have 7 cards in your hand its the limit you can not draw 1 more. Drawn card send to discard pile."
+                        << "you have " << StandardRules.handLimit << " cards in your hand its the limit you can not draw 1 more. Drawn card send to discard pile."
                         << std::endl
                         << std::endl;
                     discard2.emplace_back(library2[library2.size() - 1]);
@@ -2351,9 +10023,9 @@ int main()
 
                 for (int i = 0; i < inPlay2.size(); i++)
                 {
-                    if (inPlay2[i]->getCardtype() == "LandCard")
+                    if (inPlay2[i].getCardtype() == "LandCard")
                     {
-                        inPlay2[i]->setTapped(mana2);
+                        inPlay2[i].setTapped(mana2);
                     }
                 }
                 std::cout
@@ -2378,7 +10050,7 @@ int main()
                     for (it444 = hand2.begin(); it444 != hand2.end(); it444++)
                     {
                         std::cout << i << ")";
-                        (*it444)->printCardName();
+                        it444->printCardName();
                         std::cout << "  ";
                         i++;
                     }
@@ -2394,100 +10066,106 @@ int main()
                     {
                         break;
                     }
-                    else if (hand2[i]->isManaE(mana2))
+                    else if (i < 0 || i >= hand2.size())
+                    {
+                        std::cout << "There is no card with that index in your hand" << std::endl;
+                    }
+                    else if (hand2[i].isManaE(mana2))
                     {
 
                         std::vector<Card>::iterator itXXX;
 
-                        if (hand2[i]->getCardtype() == "LandCard")
+                        if (hand2[i].getCardtype() == "LandCard")
                         {
                             if (a < 1)
                             {
                                 a++;
-                                std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                                hand2[i]->setTapped(mana2);
-                                hand2[i]->play(mana2);
+                                std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                                hand2[i].setTapped(mana2);
+                                hand2[i].play(mana2);
                                 //(itXXX+i)->play(mana2);
                                 inPlay2.emplace_back(hand2[i]);
-                                hand2.erase(hand2.begin() + i);
+                                hand2.erase(i);
                             }
                             else
                             {
                                 std::cout << "you already have played land card you can not play 1 more" << std::endl;
                             }
                         }
-                        else if (hand2[i]->getCardtype() == "SorceryCard")
+                        else if (hand2[i].getCardtype() == "SorceryCard")
                         {
-                            std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                            hand2[i]->play(mana2);
+                            std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                            hand2[i].play(mana2);
 
-                            if (hand2[i]->getCardName() == "Disenchant")
+                            const EffectKind effect = cardEffect(hand2[i].getCardName());
+                            if (effect == EffectKind::Disenchant)
                             {
-                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i]->getCardName());
+                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "LightningBolt")
+                            else if (effect == EffectKind::LightningBolt)
                             {
-                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i]->getCardName(), player1);
+                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i].getCardName(), player1);
                             }
-                            else if (hand2[i]->getCardName() == "Flood")
+                            else if (effect == EffectKind::Flood)
                             {
-                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i]->getCardName());
+                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "Reanimate")
+                            else if (effect == EffectKind::Reanimate)
                             {
                                 reviveFromGraveEffectObj.revive(discard2, hand2);
                             }
-                            else if (hand2[i]->getCardName() == "Plague")
+                            else if (effect == EffectKind::Plague)
                             {
-                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i]->getCardName(), player1);
+                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i].getCardName(), player1);
                             }
-                            else if (hand2[i]->getCardName() == "Terror")
+                            else if (effect == EffectKind::Terror)
                             {
-                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i]->getCardName());
+                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i].getCardName());
                             }
 
                             inPlay2.emplace_back(hand2[i]);
-                            hand2.erase(hand2.begin() + i);
+                            hand2.erase(i);
                         }
-                        else if (hand2[i]->getCardtype() == "EnhancementCard")
+                        else if (hand2[i].getCardtype() == "EnhancementCard")
                         {
-                            std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                            hand2[i]->play(mana2);
+                            std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                            hand2[i].play(mana2);
 
-                            if (hand2[i]->getCardName() == "Rage")
+                            const EffectKind effect = cardEffect(hand2[i].getCardName());
+                            if (effect == EffectKind::Rage)
                             {
-                                abilityEffectObj.effectAbility(inPlay2, hand2[i]->getCardName());
+                                abilityEffectObj.effectAbility(inPlay2, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "HolyWar")
+                            else if (effect == EffectKind::HolyWar)
                             {
-                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i]->getCardName());
+                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "HolyLight")
+                            else if (effect == EffectKind::HolyLight)
                             {
-                                effectForColorEffectObj.effectThatColorMembers(inPlay1, hand2[i]->getCardName());
+                                effectForColorEffectObj.effectThatColorMembers(inPlay1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "UnholyWar")
+                            else if (effect == EffectKind::UnholyWar)
                             {
-                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i]->getCardName());
+                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "Restrain")
+                            else if (effect == EffectKind::Restrain)
                             {
-                                abilityEffectObj.effectAbility(inPlay1, hand2[i]->getCardName());
+                                abilityEffectObj.effectAbility(inPlay1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "Slow")
+                            else if (effect == EffectKind::Slow)
                             {
-                                abilityEffectObj.effectAbility(inPlay1, hand2[i]->getCardName());
+                                abilityEffectObj.effectAbility(inPlay1, hand2[i].getCardName());
                             }
 
                             inPlay2.emplace_back(hand2[i]);
-                            hand2.erase(hand2.begin() + i);
+                            hand2.erase(i);
                         }
                         else
                         {
-                            std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                            hand2[i]->play(mana2);
+                            std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                            hand2[i].play(mana2);
                             inPlay2.emplace_back(hand2[i]);
-                            hand2.erase(hand2.begin() + i);
+                            hand2.erase(i);
                         }
                     }
                     else
@@ -2522,12 +10200,12 @@ int main()
                     printLoser(player1, player2, 3);
                     break;
                 }
-                int ops;
+                int ops = 0;
 
                 int counter = 0;
                 for (int i = 0; i < inPlay2.size(); i++)
                 {
-                    if (inPlay2[i]->getCardtype() == "CreatureCard")
+                    if (inPlay2[i].getCardtype() == "CreatureCard")
                     {
                         counter++;
                     }
@@ -2536,6 +10214,12 @@ int main()
                 if (counter > 0)
                 {
 
+                    if (hasLethalOnBoard(inPlay2, hand2, mana2, inPlay1, player1))
+                    {
+                        std::cout << "Player2 can deal lethal damage this turn by attacking with every untapped creature and casting every LightningBolt the mana pays for at Player1" << std::endl
+                                  << std::endl;
+                    }
+
                     std::cout
                         << "please choose your attack squad one by one via typing its index number.Untapped creature cards will be listed below"
                         << std::endl
@@ -2543,22 +10227,21 @@ int main()
 
                     for (int i = 0; i < inPlay2.size(); i++)
                     {
-                        if (!inPlay2[i]->hasTappedInfo() && inPlay2[i]->getCardtype() == "CreatureCard")
+                        if (!inPlay2[i].hasTappedInfo() && inPlay2[i].getCardtype() == "CreatureCard")
                         {
-                            std::cout << i << ")" << inPlay2[i]->getCardName() << "  ";
+                            std::cout << i << ")" << inPlay2[i].getCardName() << "  ";
                         }
                     }
 
                     bool done = false;
-                    int indexNumber;
-                    int squadIndexLog[9];
-                    int mmm = 0;
+                    int indexNumber = 0;
+                    StaticVector<int, StandardRules.attackSquadSize> squadIndexLog;
 
                     std::cout << std::endl;
                     std::cout
                         << "if you just want to pass and if you dont want to attack please type 9; if you type any number expect 9 you have to attack"
                         << std::endl;
-                    int ops2;
+                    int ops2 = 0;
                     while (!done)
                     {
 
@@ -2576,21 +10259,28 @@ int main()
                                 << std::endl;
                             for (int i = 0; i < inPlay2.size(); i++)
                             {
-                                if (!inPlay2[i]->hasTappedInfo() && inPlay2[i]->getCardtype() == "CreatureCard")
+                                if (!inPlay2[i].hasTappedInfo() && inPlay2[i].getCardtype() == "CreatureCard")
                                 {
-                                    std::cout << i << ")" << inPlay2[i]->getCardName() << "  " << std::endl;
+                                    std::cout << i << ")" << inPlay2[i].getCardName() << "  " << std::endl;
                                 }
                             }
                             std::cin >> indexNumber;
-                            squadIndexLog[mmm] = indexNumber;
-                            mmm++;
-                            inPlay2[indexNumber]->setTapped(mana2);
+                            if (indexNumber < 0 || indexNumber >= static_cast<int>(inPlay2.size()) || inPlay2[indexNumber].hasTappedInfo() ||
+                                inPlay2[indexNumber].getCardtype() != "CreatureCard")
+                            {
+                                std::cout << "There is no untapped creature card with that index" << std::endl;
+                            }
+                            else
+                            {
+                                squadIndexLog.push_back(indexNumber);
+                                inPlay2[indexNumber].setTapped(mana2);
+                            }
 
                             std::cout
                                 << "if you are done with forming your attack squad please type 9 if you want to choose more for your attack squad please type 0"
                                 << std::endl;
                             std::cin >> ops;
-                            if (ops == 9)
+                            if (ops == 9 || squadIndexLog.full())
                             {
                                 done = true;
                             }
@@ -2607,36 +10297,39 @@ int main()
                         std::cout
                             << "dear opponent player, I mean player1, your opponent has formed its attack squad you are in danger!!! now you can choose your defence squad to arrange a welcome "
                             << std::endl;
-                        std::cout << "they are " << mmm
+                        std::cout << "they are " << squadIndexLog.size()
                                   << " many so you must choose that many defence card for your sake otherwise the excessive damage will effect your main HP if they can dominate your defence"
                                   << std::endl;
                         std::cout << "below is the list of attackers " << std::endl;
 
-                        for (int i = 0; i < mmm; i++)
+                        for (int i = 0; i < squadIndexLog.size(); i++)
                         {
-                            std::cout << inPlay2[squadIndexLog[i]]->getCardName() << std::endl;
+                            std::cout << inPlay2[squadIndexLog[i]].getCardName() << std::endl;
                         }
 
                         std::cout << "below is the list of creature cards that you can choose for your defence squad "
                                   << std::endl;
                         for (int i = 0; i < inPlay1.size(); i++)
                         {
-                            if (!inPlay1[i]->hasTappedInfo() && inPlay1[i]->getCardtype() == "CreatureCard")
+                            if (!inPlay1[i].hasTappedInfo() && inPlay1[i].getCardtype() == "CreatureCard")
                             {
-                                std::cout << i << ")" << inPlay1[i]->getCardName();
+                                std::cout << i << ")" << inPlay1[i].getCardName();
                             }
                         }
 
-                        for (int i = 0; i < mmm; i++)
+                        std::cout << std::endl;
+                        printBlockHint(inPlay2, squadIndexLog.data(), squadIndexLog.size(), inPlay1);
+
+                        for (int i = 0; i < squadIndexLog.size(); i++)
                         {
-                            std::cout << i << ". attacker is " << inPlay2[squadIndexLog[i]]->getCardName()
+                            std::cout << i << ". attacker is " << inPlay2[squadIndexLog[i]].getCardName()
                                       << ". Choose your defender via typing its index number. To pass this attacker type 9"
                                       << std::endl;
                             std::cin >> ops;
                             if (ops == 9)
                             {
-                                player1->susDamage(inPlay2[squadIndexLog[i]]->getAttackPower());
-                                std::cout << "Player take " << inPlay2[squadIndexLog[i]]->getAttackPower() << " damage" << std::endl;
+                                player1->susDamage(inPlay2[squadIndexLog[i]].getAttackPower());
+                                std::cout << "Player take " << inPlay2[squadIndexLog[i]].getAttackPower() << " damage" << std::endl;
                             }
                             // else{combat(inPlay2[squadIndexLog[i]],inPlay1[ops],player1);}
                             else
@@ -2686,7 +10379,7 @@ int main()
                     for (it444 = hand2.begin(); it444 != hand2.end(); it444++)
                     {
                         std::cout << i << ")";
-                        (*it444)->printCardName();
+                        it444->printCardName();
                         std::cout << "  ";
                         i++;
                     }
@@ -2707,100 +10400,106 @@ int main()
                     {
                         break;
                     }
-                    else if (hand2[i]->isManaE(mana2))
+                    else if (i < 0 || i >= hand2.size())
+                    {
+                        std::cout << "There is no card with that index in your hand" << std::endl;
+                    }
+                    else if (hand2[i].isManaE(mana2))
                     {
 
                         std::vector<Card>::iterator itXXX;
 
-                        if (hand2[i]->getCardtype() == "LandCard")
+                        if (hand2[i].getCardtype() == "LandCard")
                         {
                             if (a < 1)
                             {
                                 a++;
-                                std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                                hand2[i]->setTapped(mana2);
-                                hand2[i]->play(mana2);
+                                std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                                hand2[i].setTapped(mana2);
+                                hand2[i].play(mana2);
                                 //(itXXX+i)->play(mana2);
                                 inPlay2.emplace_back(hand2[i]);
-                                hand2.erase(hand2.begin() + i);
+                                hand2.erase(i);
                             }
                             else
                             {
                                 std::cout << "you already have played land in 1. play phase of this round card you can not play 1 more" << std::endl;
                             }
                         }
-                        else if (hand2[i]->getCardtype() == "SorceryCard")
+                        else if (hand2[i].getCardtype() == "SorceryCard")
                         {
-                            std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                            hand2[i]->play(mana2);
+                            std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                            hand2[i].play(mana2);
 
-                            if (hand2[i]->getCardName() == "Disenchant")
+                            const EffectKind effect = cardEffect(hand2[i].getCardName());
+                            if (effect == EffectKind::Disenchant)
                             {
-                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i]->getCardName());
+                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "LightningBolt")
+                            else if (effect == EffectKind::LightningBolt)
                             {
-                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i]->getCardName(), player1);
+                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i].getCardName(), player1);
                             }
-                            else if (hand2[i]->getCardName() == "Flood")
+                            else if (effect == EffectKind::Flood)
                             {
-                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i]->getCardName());
+                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "Reanimate")
+                            else if (effect == EffectKind::Reanimate)
                             {
                                 reviveFromGraveEffectObj.revive(discard2, hand2);
                             }
-                            else if (hand2[i]->getCardName() == "Plague")
+                            else if (effect == EffectKind::Plague)
                             {
-                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i]->getCardName(), player1);
+                                dealDamageEffectObj.dealDamage(inPlay1, hand2[i].getCardName(), player1);
                             }
-                            else if (hand2[i]->getCardName() == "Terror")
+                            else if (effect == EffectKind::Terror)
                             {
-                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i]->getCardName());
+                                destroyCardEffectObj.destroyCardEffectFunc(inPlay1, discard1, hand2[i].getCardName());
                             }
 
                             inPlay2.emplace_back(hand2[i]);
-                            hand2.erase(hand2.begin() + i);
+                            hand2.erase(i);
                         }
-                        else if (hand2[i]->getCardtype() == "EnhancementCard")
+                        else if (hand2[i].getCardtype() == "EnhancementCard")
                         {
-                            std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                            hand2[i]->play(mana2);
+                            std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                            hand2[i].play(mana2);
 
-                            if (hand2[i]->getCardName() == "Rage")
+                            const EffectKind effect = cardEffect(hand2[i].getCardName());
+                            if (effect == EffectKind::Rage)
                             {
-                                abilityEffectObj.effectAbility(inPlay2, hand2[i]->getCardName());
+                                abilityEffectObj.effectAbility(inPlay2, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "HolyWar")
+                            else if (effect == EffectKind::HolyWar)
                             {
-                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i]->getCardName());
+                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "HolyLight")
+                            else if (effect == EffectKind::HolyLight)
                             {
-                                effectForColorEffectObj.effectThatColorMembers(inPlay1, hand2[i]->getCardName());
+                                effectForColorEffectObj.effectThatColorMembers(inPlay1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "UnholyWar")
+                            else if (effect == EffectKind::UnholyWar)
                             {
-                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i]->getCardName());
+                                effectForColorEffectObj.effectThatColorMembers(inPlay2, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "Restrain")
+                            else if (effect == EffectKind::Restrain)
                             {
-                                abilityEffectObj.effectAbility(inPlay1, hand2[i]->getCardName());
+                                abilityEffectObj.effectAbility(inPlay1, hand2[i].getCardName());
                             }
-                            else if (hand2[i]->getCardName() == "Slow")
+                            else if (effect == EffectKind::Slow)
                             {
-                                abilityEffectObj.effectAbility(inPlay1, hand2[i]->getCardName());
+                                abilityEffectObj.effectAbility(inPlay1, hand2[i].getCardName());
                             }
 
                             inPlay2.emplace_back(hand2[i]);
-                            hand2.erase(hand2.begin() + i);
+                            hand2.erase(i);
                         }
                         else
                         {
-                            std::cout << "Player2 played: " << hand2[i]->getCardName() << std::endl;
-                            hand2[i]->play(mana2);
+                            std::cout << "Player2 played: " << hand2[i].getCardName() << std::endl;
+                            hand2[i].play(mana2);
                             inPlay2.emplace_back(hand2[i]);
-                            hand2.erase(hand2.begin() + i);
+                            hand2.erase(i);
                         }
                     }
                     else
@@ -2856,4 +10555,118 @@ int main()
     }
 
     return 0;
+}
+//======================================================================================================================
+/**
+ * @brief Plays the interactive game: [--seed <n>] [--record <file> | --replay-input <file>].
+ *
+ * --record writes the seed line "seed <n>" and then every input line to the file; --replay-input plays such a file
+ * back with its seed, which reproduces the session a bug report came with. Without a seed the clock picks one.
+ *
+ * @return The process exit code.
+ */
+int playCommand(int argc, char **argv)
+{
+    unsigned seed = static_cast<unsigned>(time(NULL));
+    std::string recordPath;
+    std::string replayPath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        if (i + 1 < argc && option == "--seed")
+        {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (i + 1 < argc && option == "--record")
+        {
+            recordPath = argv[++i];
+        }
+        else if (i + 1 < argc && option == "--replay-input")
+        {
+            replayPath = argv[++i];
+        }
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--seed <n>] [--record <file> | --replay-input <file>]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::streambuf *const console = std::cin.rdbuf();
+    std::ifstream replay;
+    if (!replayPath.empty())
+    {
+        std::string word;
+        replay.open(replayPath);
+        if (!(replay >> word >> seed) || word != "seed")
+        {
+            std::cout << "input record " << replayPath << " could not be read" << std::endl;
+            return 1;
+        }
+        replay.ignore(1); // the end of the seed line
+        std::cin.rdbuf(replay.rdbuf());
+    }
+
+    std::ofstream record;
+    std::unique_ptr<InputRecorder> recorder;
+    if (!recordPath.empty())
+    {
+        record.open(recordPath, std::ios::trunc);
+        if (!record)
+        {
+            std::cout << "input record " << recordPath << " could not be written" << std::endl;
+            std::cin.rdbuf(console);
+            return 1;
+        }
+        record << "seed " << seed << std::endl;
+        recorder = std::make_unique<InputRecorder>(std::cin.rdbuf(), record);
+        std::cin.rdbuf(recorder.get());
+    }
+
+    // The interactive game plays the card pool of cards.txt, or the built-in one if the file can not be loaded
+    CardDatabase database;
+    if (database.loadFile("cards.txt"))
+    {
+        useCardTable(database.table());
+    }
+    else
+    {
+        std::cout << "playing with the built-in cards" << std::endl;
+    }
+
+    const int code = playLegacyGame(getActiveCardTable(), seed);
+    std::cin.rdbuf(console); // the buffers above die with this function
+    return code;
+} // playCommand function
+//======================================================================================================================
+int main(int argc, char **argv)
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "--compile-cards")
+    {
+        return compileCardsCommand(argc, argv);
+    }
+    if (mode == "--serve-cards")
+    {
+        return serveCardsCommand(argc, argv);
+    }
+    if (mode == "--self-play")
+    {
+        return selfPlayCommand(argc, argv);
+    }
+    if (mode == "--bench-cards")
+    {
+        return benchCardsCommand(argc, argv);
+    }
+    if (mode == "--selftest")
+    {
+        return selfTestCommand();
+    }
+    if (mode == "--replay")
+    {
+        return replayCommand(argc, argv);
+    }
+    return playCommand(argc, argv);
 }
\ No newline at end of file